@@ -0,0 +1,241 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace bustub {
+
+bool ArcReplacer::GhostList::Erase(page_id_t page_id) {
+  auto it = index_.find(page_id);
+  if (it == index_.end()) {
+    return false;
+  }
+  pages_.erase(it->second);
+  index_.erase(it);
+  return true;
+}
+
+void ArcReplacer::GhostList::PushFront(page_id_t page_id) {
+  pages_.push_front(page_id);
+  index_[page_id] = pages_.begin();
+}
+
+void ArcReplacer::GhostList::PopBack() {
+  index_.erase(pages_.back());
+  pages_.pop_back();
+}
+
+ArcReplacer::ArcReplacer(size_t num_pages, uint64_t correlated_period)
+    : capacity_(num_pages), correlated_period_(correlated_period), frames_(num_pages) {}
+
+ArcReplacer::~ArcReplacer() = default;
+
+void ArcReplacer::SetList(frame_id_t frame_id, ListType list_type) {
+  FrameInfo &info = frames_[frame_id];
+  assert(!info.evictable_);
+  if (info.list_ != ListType::NONE) {
+    (info.list_ == ListType::T1 ? t1_size_ : t2_size_)--;
+  }
+  if (list_type != ListType::NONE) {
+    (list_type == ListType::T1 ? t1_size_ : t2_size_)++;
+  }
+  info.list_ = list_type;
+}
+
+void ArcReplacer::Link(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    return;
+  }
+  assert(info.list_ != ListType::NONE);
+  auto &list = info.list_ == ListType::T1 ? t1_ : t2_;
+  info.pos_ = list.insert(info.reinstated_ ? list.end() : list.begin(), frame_id);
+  info.reinstated_ = false;
+  info.evictable_ = true;
+  size_++;
+}
+
+void ArcReplacer::Unlink(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (!info.evictable_) {
+    return;
+  }
+  (info.list_ == ListType::T1 ? t1_ : t2_).erase(info.pos_);
+  info.evictable_ = false;
+  size_--;
+}
+
+void ArcReplacer::Relink(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.victim_of_ == ListType::NONE) {
+    return;
+  }
+  if (info.list_ == ListType::NONE) {
+    SetList(frame_id, info.victim_of_);
+    info.reinstated_ = true;
+  }
+  info.victim_of_ = ListType::NONE;
+}
+
+bool ArcReplacer::FindVictim(frame_id_t *frame_id) {
+  // Take from T1 while it exceeds its target size, otherwise from T2. The lists only hold evictable frames, so fall
+  // back to the other list if all frames of the preferred one are pinned.
+  const bool prefer_t1 = t1_size_ > p_;
+  for (auto *list : {prefer_t1 ? &t1_ : &t2_, prefer_t1 ? &t2_ : &t1_}) {
+    if (!list->empty()) {
+      *frame_id = list->back();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ArcReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (!FindVictim(frame_id)) {
+    return false;
+  }
+  // The page stays resident until the buffer pool claimed the frame and loads another page, see Load and Reinstate.
+  FrameInfo &info = frames_[*frame_id];
+  Unlink(*frame_id);
+  info.victim_of_ = info.list_;
+  SetList(*frame_id, ListType::NONE);
+  return true;
+}
+
+void ArcReplacer::Load(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  FrameInfo &info = frames_[frame_id];
+  Unlink(frame_id);
+  // The frame was claimed: its previous page is evicted and becomes a ghost of the list it was victimized from.
+  if (info.victim_of_ != ListType::NONE && info.page_id_ != INVALID_PAGE_ID) {
+    (info.victim_of_ == ListType::T1 ? b1_ : b2_).PushFront(info.page_id_);
+  }
+  info.victim_of_ = ListType::NONE;
+  // A ghost hit means the page would still be resident if its list had been larger: adapt the target size of T1.
+  ListType list_type = ListType::T1;
+  if (b1_.index_.count(page_id) != 0) {
+    p_ = std::min(capacity_, p_ + std::max<size_t>(b2_.Size() / b1_.Size(), 1));
+    b1_.Erase(page_id);
+    list_type = ListType::T2;
+  } else if (b2_.index_.count(page_id) != 0) {
+    p_ -= std::min(p_, std::max<size_t>(b1_.Size() / b2_.Size(), 1));
+    b2_.Erase(page_id);
+    list_type = ListType::T2;
+  }
+  // The frame is linked into its list once it is unpinned.
+  SetList(frame_id, list_type);
+  info.page_id_ = page_id;
+  info.last_ = ++current_timestamp_;
+  info.loaded_ = true;
+  info.reinstated_ = false;
+  // Remember at most capacity pages per recency list, and at most 2 * capacity pages in total.
+  while (t1_size_ + b1_.Size() > capacity_ && b1_.Size() > 0) {
+    b1_.PopBack();
+  }
+  while (t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * capacity_ && b2_.Size() > 0) {
+    b2_.PopBack();
+  }
+}
+
+void ArcReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  FrameInfo &info = frames_[frame_id];
+  Unlink(frame_id);
+  Relink(frame_id);
+  if (info.loaded_) {
+    // The pin of the load itself is no re-reference.
+    info.loaded_ = false;
+    return;
+  }
+  const uint64_t now = ++current_timestamp_;
+  if (info.list_ == ListType::NONE) {
+    SetList(frame_id, ListType::T1);
+  } else if (info.list_ == ListType::T2 || now - info.last_ > correlated_period_) {
+    SetList(frame_id, ListType::T2);
+  }
+  // A re-reference makes the frame the MRU one of its list when it is unpinned, even if it was reinstated.
+  info.reinstated_ = false;
+  info.last_ = now;
+}
+
+void ArcReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  FrameInfo &info = frames_[frame_id];
+  Relink(frame_id);
+  if (info.list_ == ListType::NONE) {
+    SetList(frame_id, ListType::T1);
+    info.last_ = ++current_timestamp_;
+  }
+  // A prefetched frame is unpinned before its first pin, which stays the load and no re-reference.
+  Link(frame_id);
+}
+
+void ArcReplacer::Reinstate(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  Relink(frame_id);
+}
+
+void ArcReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  FrameInfo &info = frames_[frame_id];
+  Unlink(frame_id);
+  SetList(frame_id, ListType::NONE);
+  info.victim_of_ = ListType::NONE;
+  info.page_id_ = INVALID_PAGE_ID;
+  info.loaded_ = false;
+  info.reinstated_ = false;
+}
+
+void ArcReplacer::SetNumFrames(size_t num_frames) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(num_frames <= frames_.size());
+  capacity_ = num_frames;
+  p_ = std::min(capacity_, p_);
+  // The ghost lists shrink with the next loads.
+}
+
+size_t ArcReplacer::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return size_;
+}
+
+frame_id_t ArcReplacer::NextVictimHint() {
+  std::lock_guard<std::mutex> lock(latch_);
+  frame_id_t frame_id = 0;
+  FindVictim(&frame_id);
+  return frame_id;
+}
+
+void ArcReplacer::SortByHotness(std::vector<frame_id_t> *frame_ids) {
+  std::lock_guard<std::mutex> lock(latch_);
+  // Pinned frames are in no list, so rank by list membership and the time of the last reference instead.
+  auto list_rank = [](ListType list_type) { return list_type == ListType::T2 ? 0 : list_type == ListType::T1 ? 1 : 2; };
+  std::stable_sort(frame_ids->begin(), frame_ids->end(), [this, &list_rank](frame_id_t a, frame_id_t b) {
+    const FrameInfo &info_a = frames_[a];
+    const FrameInfo &info_b = frames_[b];
+    if (info_a.list_ != info_b.list_) {
+      return list_rank(info_a.list_) < list_rank(info_b.list_);
+    }
+    return info_a.list_ != ListType::NONE && info_a.last_ > info_b.last_;
+  });
+}
+
+}  // namespace bustub
@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <algorithm>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+BufferAccessStrategy::BufferAccessStrategy(BufferPoolManager *bpm, size_t ring_size)
+    : ring_size_(std::max<size_t>(std::min(ring_size, bpm->GetPoolSize() / 8), 1)) {
+  ring_.reserve(ring_size_);
+}
+
+bool BufferAccessStrategy::NextSlot(BufferPoolManager *owner, frame_id_t *frame_id, page_id_t *page_id) const {
+  if (ring_.size() < ring_size_ || ring_[next_].owner_ != owner) {
+    return false;
+  }
+  *frame_id = ring_[next_].frame_id_;
+  *page_id = ring_[next_].page_id_;
+  return true;
+}
+
+void BufferAccessStrategy::Record(BufferPoolManager *owner, frame_id_t frame_id, page_id_t page_id) {
+  if (ring_.size() < ring_size_) {
+    ring_.push_back({owner, frame_id, page_id});
+    return;
+  }
+  ring_[next_] = {owner, frame_id, page_id};
+  next_ = (next_ + 1) % ring_size_;
+}
+
+}  // namespace bustub
@@ -13,136 +13,492 @@
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"  // NOLINT
 
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <list>  // NOLINT
-#include <unordered_map>  // NOLINT
+#include <new>
+#include <numeric>
 
 namespace bustub {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new ClockReplacer(pool_size);
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+                                     size_t num_shards, ReplacerType replacer_type, size_t max_pool_size)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      // A partitioned pool routes every request to a shard and never uses its own page table.
+      page_table_(num_shards > 1 ? 0 : max_pool_size_) {
+  assert(num_shards > 0 && num_shards <= pool_size_);
+  // We allocate a consecutive memory space for the buffer pool: a dense array of frame book-keeping, and an aligned
+  // region for the page data of the frames. Both are reserved for max_pool_size_ frames, the frames beyond the pool
+  // size are never touched and cost no memory until the pool grows.
+  frame_data_ = AllocateFrameData(max_pool_size_);
+  pages_ = static_cast<Page *>(::operator new(max_pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_data_ + i * PAGE_SIZE);
+  }
+  if (num_shards > 1) {
+    // Partitioned mode: every shard owns a consecutive slice of the frames together with its own page table,
+    // free list, replacer and latch. This object only routes requests to the shards.
+    replacer_ = nullptr;
+    shards_.reserve(num_shards);
+    size_t offset = 0;
+    for (size_t i = 0; i < num_shards; ++i) {
+      const size_t shard_max_size = ShardSize(max_pool_size_, i, num_shards);
+      shards_.push_back(new BufferPoolManager(ShardSize(pool_size_, i, num_shards), shard_max_size, pages_ + offset,
+                                              disk_manager_, log_manager_, replacer_type));
+      offset += shard_max_size;
+    }
+    return;
+  }
+  InitFrames(replacer_type);
+}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, size_t max_pool_size, Page *pages, DiskManager *disk_manager,
+                                     LogManager *log_manager, ReplacerType replacer_type)
+    : pool_size_(pool_size),
+      max_pool_size_(max_pool_size),
+      pages_(pages),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(max_pool_size),
+      owns_pages_(false) {
+  InitFrames(replacer_type);
+}
+
+void BufferPoolManager::InitFrames(ReplacerType replacer_type) {
+  replacer_ = MakeReplacer(replacer_type, max_pool_size_);
+  swizzled_refs_ = std::vector<std::atomic<SwizzledPageRef *>>(max_pool_size_);
+  replacer_->SetNumFrames(pool_size_);
+  // Initially, every page is in the free list. Reserved frames beyond the pool size are claimed forever.
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    if (i < pool_size_) {
+      free_list_.emplace_back(static_cast<int>(i));
+    }
+    pages_[i].pin_count_ = FRAME_CLAIMED;
+  }
+  num_staging_slots_ = write_back_staging_pages;
+  if (num_staging_slots_ > 0) {
+    staging_data_ = AllocateFrameData(num_staging_slots_);
+    for (size_t i = 0; i < num_staging_slots_; ++i) {
+      free_staging_slots_.push_back(staging_data_ + i * PAGE_SIZE);
+    }
+  }
+}
+
+Replacer *BufferPoolManager::MakeReplacer(ReplacerType replacer_type, size_t pool_size) {
+  switch (replacer_type) {
+    case ReplacerType::LRU_K:
+      return new LRUKReplacer(pool_size, LRUK_REPLACER_K, REPLACER_CORRELATED_PERIOD);
+    case ReplacerType::ARC:
+      return new ArcReplacer(pool_size, REPLACER_CORRELATED_PERIOD);
+    case ReplacerType::LOCK_FREE_CLOCK:
+      return new LockFreeClockReplacer(pool_size);
+    case ReplacerType::CLOCK:
+    default:
+      return new ClockReplacer(pool_size);
   }
 }
 
+char *BufferPoolManager::AllocateFrameData(size_t pool_size) {
+  // Anonymous mappings are page-aligned and zeroed. Memory is only committed once a frame is touched, so reserving
+  // frames for a later Resize does not count against the system.
+  void *frame_data = mmap(nullptr, pool_size * PAGE_SIZE, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (frame_data == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  if (buffer_pool_huge_pages && madvise(frame_data, pool_size * PAGE_SIZE, MADV_HUGEPAGE) != 0) {
+    LOG_WARN("transparent huge pages are not available for the buffer pool");
+  }
+  return static_cast<char *>(frame_data);
+}
+
+void BufferPoolManager::FreeFrameData(char *frame_data, size_t pool_size) {
+  munmap(frame_data, pool_size * PAGE_SIZE);
+}
+
 BufferPoolManager::~BufferPoolManager() {
+  if (warmup_thread_ != nullptr) {
+    stop_warmup_ = true;
+    WaitForWarmup();
+  }
+  if (!warmup_file_.empty() && !SaveWarmupSnapshot(warmup_file_)) {
+    LOG_WARN("the warm-up snapshot could not be saved");
+  }
+  if (page_cleaner_thread_ != nullptr) {
+    StopPageCleaner();
+  }
+  if (prefetch_thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> lock(prefetch_latch_);
+      stop_prefetch_ = true;
+    }
+    prefetch_cv_.notify_one();
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
+  // Evicted pages reach the disk even if the pool is not flushed: the write-back thread drains its queue first.
+  if (write_back_thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> lock(staging_latch_);
+      stop_write_back_ = true;
+    }
+    staging_cv_.notify_all();
+    write_back_thread_->join();
+    delete write_back_thread_;
+  }
+  if (staging_data_ != nullptr) {
+    FreeFrameData(staging_data_, num_staging_slots_);
+  }
   //  Project4 require Buffer Pool Manager not to flush all dirty pages.
   //  FlushAllPagesImpl();  // Add by Jigao
-  delete[] pages_;
+  for (auto shard : shards_) {
+    delete shard;
+  }
+  if (owns_pages_) {
+    for (size_t i = 0; i < max_pool_size_; ++i) {
+      pages_[i].~Page();
+    }
+    ::operator delete(pages_);
+    FreeFrameData(frame_data_, max_pool_size_);
+  }
   delete replacer_;
 }
 
-Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
+Page *BufferPoolManager::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
   assert(page_id != INVALID_PAGE_ID);
-  std::unique_lock u_lock(global_latch_);
-  // 1.     Search the page table for the requested page (P).
-  const auto& got = page_table_.find(page_id);
-  // 1.1    If P exists, pin it and return it immediately.
-  if (got != page_table_.end()) {
-    Page *const page = pages_ + got->second;
-    if (page->pin_count_++ == 0) {
-      replacer_->Pin(got->second);
+  if (trace_recorder_.IsRecording()) {
+    trace_recorder_.Record(page_id, PageTraceOp::FETCH);
+  }
+  return FetchPageUntraced(page_id, strategy);
+}
+
+Page *BufferPoolManager::FetchPageUntraced(page_id_t page_id, BufferAccessStrategy *strategy) {
+  if (!shards_.empty()) {
+    return ShardOf(page_id)->FetchPageUntraced(page_id, strategy);
+  }
+  // 1.     Search the page table for the requested page (P). Hits are lock-free.
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    // 1.1    If P exists, pin it and return it immediately.
+    Page *const page = TryPinFrame(frame_id, page_id);
+    if (page != nullptr) {
+      return page;
     }
-    return page;
   }
-  // 2.   If all the pages in the buffer pool are pinned, return nullptr.
+  std::unique_lock u_lock(global_latch_);
+  // 1.2    Search again, another thread may have loaded P or P was being evicted.
+  //        No frame is claimed while the latch is held exclusively.
+  if (page_table_.Find(page_id, &frame_id)) {
+    return PinFrame(frame_id);
+  }
+  // 2.   If all the pages in the buffer pool are pinned, return nullptr. A lock-free unpin may be dropping a pin
+  //      right now without having reached the replacer yet, so the pin counts are not checked here.
   if (free_list_.empty() && replacer_->Size() == 0) {
-    assert(IsAllPinned());
     return nullptr;
   }
   // 3.   Pick a victim page
-  return Evict(page_id, false, &u_lock);
+  return Evict(page_id, false, &u_lock, strategy);
+}
+
+Page *BufferPoolManager::FetchSwizzled(SwizzledPageRef *ref) {
+  if (trace_recorder_.IsRecording()) {
+    trace_recorder_.Record(ref->page_id_, PageTraceOp::FETCH);
+  }
+  if (!shards_.empty()) {
+    return ShardOf(ref->page_id_)->FetchSwizzled(ref);
+  }
+  // 1.   A swizzled reference pins its frame without a page table lookup. The frame may have been claimed since the
+  //      reference was read, then the pin fails and the page is fetched the normal way.
+  Page *const frame = ref->frame_.load(std::memory_order_acquire);
+  if (frame != nullptr) {
+    Page *const page = TryPinFrame(static_cast<frame_id_t>(frame - pages_), ref->page_id_);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  // 2.   Fetch the page, then swizzle the reference. The pin keeps the frame from being claimed meanwhile. The fetch
+  //      was traced already.
+  Page *const page = FetchPageUntraced(ref->page_id_, nullptr);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  SwizzledPageRef *expected = nullptr;
+  if (swizzled_refs_[page - pages_].compare_exchange_strong(expected, ref)) {
+    ref->frame_.store(page, std::memory_order_release);
+  }
+  return page;
+}
+
+bool BufferPoolManager::UnpinSwizzled(Page *page, bool is_dirty) {
+  if (!shards_.empty()) {
+    return ShardOf(page->page_id_)->UnpinSwizzled(page, is_dirty);
+  }
+  if (page->pin_count_ <= 0) {
+    return false;
+  }
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  return UnpinFrame(static_cast<frame_id_t>(page - pages_));
+}
+
+void BufferPoolManager::Unswizzle(SwizzledPageRef *ref) {
+  if (!shards_.empty()) {
+    ShardOf(ref->page_id_)->Unswizzle(ref);
+    return;
+  }
+  // Frames are only claimed under the exclusive latch, so the frame cannot be unswizzled concurrently.
+  std::lock_guard<std::shared_mutex> lock(global_latch_);
+  Page *const frame = ref->frame_.load(std::memory_order_relaxed);
+  if (frame != nullptr) {
+    SwizzledPageRef *expected = ref;
+    swizzled_refs_[frame - pages_].compare_exchange_strong(expected, nullptr);
+    ref->frame_.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+void BufferPoolManager::UnswizzleFrame(frame_id_t frame_id) {
+  SwizzledPageRef *const ref = swizzled_refs_[frame_id].exchange(nullptr);
+  if (ref != nullptr) {
+    ref->frame_.store(nullptr, std::memory_order_release);
+  }
+}
+
+bool BufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) {
+  if (trace_recorder_.IsRecording()) {
+    for (const page_id_t page_id : page_ids) {
+      trace_recorder_.Record(page_id, PageTraceOp::FETCH);
+    }
+  }
+  if (FetchPagesImpl(page_ids, pages)) {
+    return true;
+  }
+  // Some frame was pinned: give back the pages fetched so far, so that the caller never holds a partial batch.
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    if (pages[i] != nullptr) {
+      UnpinPageImpl(page_ids[i], false);
+      pages[i] = nullptr;
+    }
+  }
+  return false;
+}
+
+bool BufferPoolManager::FetchPagesImpl(const std::vector<page_id_t> &page_ids, Page **pages, bool prefetch) {
+  // 1.   Pin the hits and claim frames for the misses, shard by shard, without doing any I/O yet.
+  std::vector<PendingRead> reads;
+  if (shards_.empty()) {
+    std::vector<size_t> indices(page_ids.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    ClaimPages(page_ids, indices, pages, &reads, prefetch);
+  } else {
+    std::vector<std::vector<size_t>> shard_indices(shards_.size());
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      // Same routing as ShardOf.
+      shard_indices[static_cast<size_t>(page_ids[i]) % shards_.size()].push_back(i);
+    }
+    for (size_t shard = 0; shard < shards_.size(); shard++) {
+      if (!shard_indices[shard].empty()) {
+        shards_[shard]->ClaimPages(page_ids, shard_indices[shard], pages, &reads, prefetch);
+      }
+    }
+  }
+  // 2.   Write back the dirty victims which could not be staged. Then load the misses with a pending write-back from
+  //      memory, and read all others with one asynchronous batch.
+  for (const auto &read : reads) {
+    if (read.victim_dirty_) {
+      read.shard_->WriteBackVictim(read.page_, read.victim_page_id_, false);
+    }
+  }
+  std::vector<page_id_t> read_page_ids;
+  std::vector<char *> read_page_data;
+  read_page_ids.reserve(reads.size());
+  read_page_data.reserve(reads.size());
+  for (const auto &read : reads) {
+    if (!read.shard_->ReadStaged(read.page_)) {
+      read_page_ids.push_back(read.page_->page_id_);
+      read_page_data.push_back(read.page_->data_);
+    }
+  }
+  if (!read_page_ids.empty()) {
+    disk_manager_->ReadPages(read_page_ids, read_page_data);
+  }
+  // 3.   Publish the loaded pages.
+  for (const auto &read : reads) {
+    read.page_->WUnlatch();
+  }
+  return std::all_of(pages, pages + page_ids.size(), [](Page *page) { return page != nullptr; });
+}
+
+void BufferPoolManager::ClaimPages(const std::vector<page_id_t> &page_ids, const std::vector<size_t> &indices,
+                                   Page **pages, std::vector<PendingRead> *reads, bool prefetch) {
+  // 1.   Hits are pinned lock-free, like in FetchPageImpl. A prefetch leaves them alone.
+  std::vector<size_t> misses;
+  for (const size_t i : indices) {
+    assert(page_ids[i] != INVALID_PAGE_ID);
+    frame_id_t frame_id;
+    const bool hit = page_table_.Find(page_ids[i], &frame_id);
+    pages[i] = hit && !prefetch ? TryPinFrame(frame_id, page_ids[i]) : nullptr;
+    if (pages[i] == nullptr && !(hit && prefetch)) {
+      misses.push_back(i);
+    }
+  }
+  if (misses.empty()) {
+    return;
+  }
+  // 2.   Claim a frame for every miss under a single acquisition of the latch. The frames stay write latched until
+  //      the caller has read their pages, so concurrent hits on them wait for the data.
+  std::unique_lock u_lock(global_latch_);
+  // A prefetch pins its frames until their pages are read. It claims at most half of the free and evictable frames,
+  // the others are left to the foreground: a fetch running meanwhile must not fail for lack of frames.
+  size_t prefetch_budget = (free_list_.size() + replacer_->Size()) / 2;
+  for (const size_t i : misses) {
+    if (prefetch && prefetch_budget-- == 0) {
+      break;
+    }
+    // 2.1    Another thread may have loaded the page meanwhile, or it is a duplicate of a page claimed above.
+    frame_id_t frame_id;
+    if (page_table_.Find(page_ids[i], &frame_id)) {
+      if (!prefetch) {
+        pages[i] = PinFrame(frame_id);
+      }
+      continue;
+    }
+    // 2.2    If all the pages in the buffer pool are pinned, the page cannot be fetched.
+    if (free_list_.empty() && replacer_->Size() == 0) {
+      continue;
+    }
+    PendingRead read{this, nullptr, INVALID_PAGE_ID, false};
+    read.page_ =
+        ClaimFrame(page_ids[i], false, nullptr, prefetch, &read.victim_page_id_, &read.victim_dirty_, nullptr);
+    pages[i] = read.page_;
+    if (read.page_ != nullptr) {
+      reads->push_back(read);
+    }
+  }
 }
 
 bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
   assert(page_id != INVALID_PAGE_ID);
-  std::unique_lock u_lock(global_latch_);
-  // 1. search page table.
-  const auto& got = page_table_.find(page_id);
-  assert(got != page_table_.end());
-  auto page = pages_ + got->second;
+  if (!shards_.empty()) {
+    return ShardOf(page_id)->UnpinPageImpl(page_id, is_dirty);
+  }
+  // 1. search page table. The caller holds a pin, so the page cannot be evicted and no latch is needed.
+  frame_id_t frame_id;
+  [[maybe_unused]] const bool found = page_table_.Find(page_id, &frame_id);
+  assert(found);
+  Page *const page = pages_ + frame_id;
   // 2. if pin_count <= 0 before this call, return false
   if (page->pin_count_ <= 0) {
     return false;
   }
-  // 3. if pin_count > 0, decrement it and if it becomes zero, put it back to replacer
-  if (--page->pin_count_ == 0) {
-    replacer_->Unpin(got->second);
+  // 3. is_dirty: set the dirty flag of this page. Before dropping the pin, an eviction must see the flag.
+  if (is_dirty) {
+    page->is_dirty_ = true;
   }
-  // 4. is_dirty: set the dirty flag of this page
-  page->is_dirty_ |= is_dirty;
-  return true;
+  // 4. decrement pin_count and if it becomes zero, put it back to replacer
+  return UnpinFrame(frame_id);
 }
 
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
   assert(page_id != INVALID_PAGE_ID);
+  if (!shards_.empty()) {
+    return ShardOf(page_id)->FlushPageImpl(page_id);
+  }
   // Make sure you call DiskManager::WritePage!
   std::shared_lock s_lock(global_latch_);
   // 1. search page table.
-  const auto& got = page_table_.find(page_id);
-  if (got == page_table_.end()) {
-    // 1.1. if page is not found in page table, return false
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    // 1.1. if page is not found in page table, return false. An evicted page may still be on its way to disk.
     s_lock.unlock();
+    WaitForStagedWrites(page_id);
     return false;
   }
   // 1.2. if page is not found in page table and dirty, call the write_page method of the disk manager
-  const auto page = pages_ + got->second;
+  const auto page = pages_ + frame_id;
   page->WLatch();
   s_lock.unlock();
   if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_) {
     page->is_dirty_ = false;
+    DropStagedWrite(page->page_id_);
     disk_manager_->WritePage(page->page_id_, page->data_);
   }
   page->WUnlatch();
   return true;
 }
 
-Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
-  std::unique_lock u_lock(global_latch_);
-  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  if (free_list_.empty() && replacer_->Size() == 0) {
-    assert(IsAllPinned());
+Page *BufferPoolManager::NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) {
+  // 1.   Call disk manager to allocate a page before taking the latch: an allocation may sync the superblock, which
+  //      must not stall the misses of the whole pool. The page id also decides the shard, if the pool is partitioned.
+  const page_id_t new_page_id = disk_manager_->AllocatePage(hint);
+  // 2.   Pick a victim page. If all the pages in the buffer pool or shard are pinned, give the page id back.
+  Page *const page = (shards_.empty() ? this : ShardOf(new_page_id))->NewPageInShard(new_page_id, strategy);
+  if (page == nullptr) {
+    disk_manager_->DeallocatePage(new_page_id);
     *page_id = INVALID_PAGE_ID;
     return nullptr;
   }
-  // 2.   call disk manager to allocate a page
-  page_id_t new_page_id = disk_manager_->AllocatePage();
-  // 3.   Pick a victim page
-  Page *const page = Evict(new_page_id, true, &u_lock);
-  // 4.   Set the page ID output parameter. Return a pointer to P.
+  // 3.   Set the page ID output parameter. Return a pointer to P.
   *page_id = new_page_id;
+  if (trace_recorder_.IsRecording()) {
+    trace_recorder_.Record(new_page_id, PageTraceOp::NEW);
+  }
   return page;
 }
 
+Page *BufferPoolManager::NewPageInShard(page_id_t page_id, BufferAccessStrategy *strategy) {
+  std::unique_lock u_lock(global_latch_);
+  // 1.   If all the pages in this shard are pinned, return nullptr.
+  if (free_list_.empty() && replacer_->Size() == 0) {
+    return nullptr;
+  }
+  // 2.   Pick a victim page
+  return Evict(page_id, true, &u_lock, strategy);
+}
+
 bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   assert(page_id != INVALID_PAGE_ID);
+  if (!shards_.empty()) {
+    return ShardOf(page_id)->DeletePageImpl(page_id);
+  }
   std::unique_lock u_lock(global_latch_);
   // 1.   Search the page table for the requested page (P).
-  const auto& got = page_table_.find(page_id);
-  if (got == page_table_.end()) {
-    // 1.   If P does not exist, return true.
+  frame_id_t offset;
+  if (!page_table_.Find(page_id, &offset)) {
+    // 1.   If P does not exist, return true. A pending write-back of P is no longer needed.
     u_lock.unlock();
+    DropStagedWrite(page_id);
     disk_manager_->DeallocatePage(page_id);
     return true;
   }
-  const auto offset = got->second;
   Page *const page = pages_ + offset;
   page->WLatch();
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  if (page->pin_count_ != 0) {
+  //      Otherwise claim the frame, so that no lock-free hit can pin it any more.
+  int pin_count = 0;
+  if (!page->pin_count_.compare_exchange_strong(pin_count, FRAME_CLAIMED)) {
     u_lock.unlock();
     page->WUnlatch();
     return false;
   }
   // 3.   Otherwise, P can be deleted.
   // Remove P from the page table, reset its metadata and return it to the free list.
-  replacer_->Pin(offset);  // Remove from replacer, since the pin count is 0
-  page_table_.erase(got);
-  free_list_.emplace_back(offset);
+  replacer_->Remove(offset);  // Remove from replacer, since the pin count is 0
+  page_table_.Erase(page_id);
+  UnswizzleFrame(offset);
+  // A frame beyond the pool size is being drained by Resize, it must not be handed out again.
+  if (static_cast<size_t>(offset) < pool_size_) {
+    free_list_.emplace_back(offset);
+  }
   u_lock.unlock();
 
   disk_manager_->DeallocatePage(page_id);
@@ -154,19 +510,635 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
 }
 
 void BufferPoolManager::FlushAllPagesImpl() {
-  std::lock_guard<std::shared_mutex> lock(global_latch_);
-  for (size_t i = 0; i < pool_size_; i++) {
-    const auto page = pages_ + i;
-    if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_) {
-      disk_manager_->WritePage(page->page_id_, page->data_);
+  // 1.   Snapshot the dirty pages of every shard and sort them by page id. The shards interleave the page ids, so
+  //      only the whole set has runs of consecutive pages.
+  std::vector<DirtyPage> dirty_pages;
+  if (shards_.empty()) {
+    CollectDirtyPages(&dirty_pages);
+  } else {
+    for (auto shard : shards_) {
+      shard->CollectDirtyPages(&dirty_pages);
+    }
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end(),
+            [](const DirtyPage &a, const DirtyPage &b) { return a.page_id_ < b.page_id_; });
+  // 2.   Write them without the latch, fetches and evictions go on meanwhile. Then make the whole flush durable at
+  //      once.
+  WriteDirtyPages(dirty_pages);
+  disk_manager_->SyncDataFile();
+}
+
+void BufferPoolManager::CollectDirtyPages(std::vector<DirtyPage> *dirty_pages) {
+  {
+    // Frames only change their page under the exclusive latch. Frames being drained by a shrinking Resize may still
+    // hold dirty pages.
+    std::shared_lock s_lock(global_latch_);
+    for (size_t i = 0; i < max_pool_size_; i++) {
+      Page *const page = pages_ + i;
+      if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_) {
+        dirty_pages->push_back(DirtyPage{this, page, page->page_id_});
+      }
+    }
+  }
+  // Pages evicted before the snapshot are on their way to disk.
+  WaitForStagedWrites();
+}
+
+void BufferPoolManager::WriteDirtyPages(const std::vector<DirtyPage> &dirty_pages) {
+  // Read latch a batch of pages, so that they are neither modified nor evicted while they are written, and write it
+  // with one submission: runs of consecutive pages become single vectored writes. While latches are held, other
+  // latches are only tried: the holder of a busy latch may be waiting for a frame of the batch. Busy pages are
+  // written one by one at the end. Misses do not wait for the batch under the exclusive latch, they skip latched
+  // frames when they look for a victim, see PickVictim.
+  std::vector<DirtyPage> busy_pages;
+  std::vector<Page *> latched;
+  std::vector<DiskManager::PageIO> writes;
+  size_t i = 0;
+  while (i < dirty_pages.size()) {
+    lsn_t max_lsn = INVALID_LSN;
+    for (; i < dirty_pages.size() && writes.size() < FLUSH_BATCH_PAGES; i++) {
+      Page *const page = dirty_pages[i].page_;
+      if (!page->TryRLatch()) {
+        busy_pages.push_back(dirty_pages[i]);
+        continue;
+      }
+      if (!StartFlush(dirty_pages[i])) {
+        continue;
+      }
+      max_lsn = std::max(max_lsn, page->GetLSN());
+      latched.push_back(page);
+      writes.push_back(DiskManager::PageIO{dirty_pages[i].page_id_, page->data_, true});
+    }
+    // WAL: the log records of the pages have to be persistent before the pages are written.
+    if (enable_logging && log_manager_->GetPersistentLSN() < max_lsn) {
+      log_manager_->Flush(true);
+    }
+    disk_manager_->SubmitBatch(writes).get();
+    for (Page *page : latched) {
+      page->RUnlatch();
+    }
+    latched.clear();
+    writes.clear();
+  }
+  for (const DirtyPage &dirty_page : busy_pages) {
+    Page *const page = dirty_page.page_;
+    page->RLatch();
+    if (!StartFlush(dirty_page)) {
+      continue;
+    }
+    if (enable_logging && log_manager_->GetPersistentLSN() < page->GetLSN()) {
+      log_manager_->Flush(true);
+    }
+    disk_manager_->WritePage(dirty_page.page_id_, page->data_);
+    page->RUnlatch();
+  }
+}
+
+bool BufferPoolManager::StartFlush(const DirtyPage &dirty_page) {
+  Page *const page = dirty_page.page_;
+  if (page->page_id_ != dirty_page.page_id_) {
+    // The page was evicted since the snapshot. Its write-back may still be pending.
+    page->RUnlatch();
+    dirty_page.shard_->WaitForStagedWrites(dirty_page.page_id_);
+    return false;
+  }
+  if (!page->is_dirty_) {
+    // Written back meanwhile, e.g. by the page cleaner.
+    page->RUnlatch();
+    return false;
+  }
+  page->is_dirty_ = false;
+  // An older copy of the page may still be queued for write-back, the new write supersedes it.
+  dirty_page.shard_->DropStagedWrite(dirty_page.page_id_);
+  return true;
+}
+
+bool BufferPoolManager::Resize(size_t new_pool_size) {
+  std::lock_guard<std::mutex> resize_lock(resize_latch_);
+  if (new_pool_size < GetNumShards() || new_pool_size > max_pool_size_) {
+    return false;
+  }
+  if (!shards_.empty()) {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i]->Resize(ShardSize(new_pool_size, i, shards_.size()));
+    }
+    pool_size_ = new_pool_size;
+    return true;
+  }
+  const size_t old_pool_size = pool_size_;
+  if (new_pool_size >= old_pool_size) {
+    // Growing: the reserved frames are zeroed, hand them to the free list.
+    std::lock_guard<std::shared_mutex> lock(global_latch_);
+    replacer_->SetNumFrames(new_pool_size);
+    for (size_t i = old_pool_size; i < new_pool_size; ++i) {
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = new_pool_size;
+    return true;
+  }
+  // Shrinking: stop handing out the frames beyond the new size, then drain them one by one while the pool keeps
+  // serving requests with the remaining frames.
+  {
+    std::lock_guard<std::shared_mutex> lock(global_latch_);
+    pool_size_ = new_pool_size;
+    replacer_->SetNumFrames(new_pool_size);
+    free_list_.remove_if(
+        [new_pool_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= new_pool_size; });
+  }
+  for (size_t i = new_pool_size; i < old_pool_size; ++i) {
+    DrainFrame(static_cast<frame_id_t>(i));
+  }
+  // Give the memory of the drained frames back to the system. It reads as zeroes when the pool grows again.
+  if (madvise(pages_[new_pool_size].data_, (old_pool_size - new_pool_size) * PAGE_SIZE, MADV_DONTNEED) != 0) {
+    LOG_WARN("the memory of the drained frames could not be released");
+  }
+  return true;
+}
+
+void BufferPoolManager::DrainFrame(frame_id_t frame_id) {
+  Page *const page = pages_ + frame_id;
+  while (true) {
+    // Write back a dirty page before claiming the frame, like the page cleaner, so that it stays fetchable meanwhile.
+    if (page->pin_count_ == 0 && page->is_dirty_) {
+      CleanFrame(page);
+    }
+    std::unique_lock u_lock(global_latch_);
+    // 1.   A free frame is done. A deletion may still be resetting it: wait for its write latch.
+    if (page->pin_count_ == FRAME_CLAIMED) {
+      u_lock.unlock();
+      page->WLatch();
+      page->WUnlatch();
+      return;
+    }
+    // 2.   An unpinned page is evicted, no lock-free hit can pin it once the frame is claimed.
+    int pin_count = 0;
+    if (page->pin_count_.compare_exchange_strong(pin_count, FRAME_CLAIMED)) {
+      const page_id_t page_id = page->page_id_;
+      replacer_->Remove(frame_id);
+      page_table_.Erase(page_id);
+      UnswizzleFrame(frame_id);
+      num_evictions_++;
+      page->WLatch();
+      // A dirty page is staged like a victim, it stays fetchable until it is on disk.
+      const bool write_back = page->is_dirty_ && !StageVictim(page, page_id);
+      u_lock.unlock();
+      if (write_back) {
+        WriteBackVictim(page, page_id, false);
+      }
+      page->page_id_ = INVALID_PAGE_ID;
       page->is_dirty_ = false;
+      page->WUnlatch();
+      return;
     }
+    // 3.   A pinned page stays until its users unpin it.
+    u_lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
   }
 }
 
-Page *BufferPoolManager::Evict(page_id_t page_id, bool new_page, std::unique_lock<std::shared_mutex>* u_lock) {
+bool BufferPoolManager::EnableWarmupSnapshot(const std::string &file_name) {
+  warmup_file_ = file_name;
+  std::vector<page_id_t> page_ids;
+  {
+    std::ifstream file(file_name, std::ios::binary | std::ios::in | std::ios::ate);
+    if (!file.is_open()) {
+      return false;
+    }
+    const auto file_size = static_cast<size_t>(file.tellg());
+    page_ids.resize(file_size / sizeof(page_id_t));
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(page_ids.data()), static_cast<std::streamsize>(file_size));
+    if (!file || file_size % sizeof(page_id_t) != 0) {
+      return false;
+    }
+  }
+  // The snapshot may come from another database file, or be corrupt. Drop the ids which were never allocated here, they
+  // would be read as garbage.
+  const page_id_t num_allocated = disk_manager_->GetNumAllocatedPages();
+  page_ids.erase(std::remove_if(page_ids.begin(), page_ids.end(),
+                                [num_allocated](page_id_t page_id) { return page_id < 0 || page_id >= num_allocated; }),
+                 page_ids.end());
+  // Only the hottest pages fit into the pool. Load them in file order, so that runs of pages become large reads.
+  page_ids.resize(std::min(page_ids.size(), static_cast<size_t>(pool_size_)));
+  std::sort(page_ids.begin(), page_ids.end());
+  page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+  warmup_thread_ = new std::thread([this, page_ids = std::move(page_ids)] {
+    std::vector<page_id_t> batch;
+    std::vector<Page *> pages;
+    for (size_t i = 0; i < page_ids.size() && !stop_warmup_; i += batch.size()) {
+      // The warm-up only loads as many pages as there are free frames, and stops when they are used up. It leaves the
+      // pages of the traffic which arrived meanwhile alone.
+      const size_t num_pages = std::min({page_ids.size() - i, WARMUP_BATCH_PAGES, GetFreeListSize()});
+      if (num_pages == 0) {
+        break;
+      }
+      batch.assign(page_ids.begin() + i, page_ids.begin() + i + num_pages);
+      pages.assign(num_pages, nullptr);
+      FetchPagesImpl(batch, pages.data());
+      for (size_t j = 0; j < num_pages; j++) {
+        if (pages[j] != nullptr) {
+          UnpinPageImpl(batch[j], false);
+          num_warmup_pages_++;
+        }
+      }
+    }
+  });
+  return true;
+}
+
+bool BufferPoolManager::SaveWarmupSnapshot(const std::string &file_name) {
+  std::vector<page_id_t> page_ids;
+  if (shards_.empty()) {
+    CollectHotPages(&page_ids);
+  } else {
+    // Interleave the shards, they hold pages of similar hotness at similar ranks.
+    std::vector<std::vector<page_id_t>> shard_page_ids(shards_.size());
+    size_t max_size = 0;
+    for (size_t i = 0; i < shards_.size(); i++) {
+      shards_[i]->CollectHotPages(&shard_page_ids[i]);
+      max_size = std::max(max_size, shard_page_ids[i].size());
+    }
+    for (size_t rank = 0; rank < max_size; rank++) {
+      for (const auto &shard : shard_page_ids) {
+        if (rank < shard.size()) {
+          page_ids.push_back(shard[rank]);
+        }
+      }
+    }
+  }
+  // Write a new file and rename it, a crash never leaves a torn snapshot behind.
+  const std::string tmp_file_name = file_name + ".tmp";
+  {
+    FILE *file = std::fopen(tmp_file_name.c_str(), "wb");
+    if (file == nullptr) {
+      return false;
+    }
+    // The data must be on the disk before the rename is, or a crash leaves an empty snapshot behind.
+    const bool written = std::fwrite(page_ids.data(), sizeof(page_id_t), page_ids.size(), file) == page_ids.size() &&
+                         std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (std::fclose(file) != 0 || !written) {
+      return false;
+    }
+  }
+  return std::rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+void BufferPoolManager::CollectHotPages(std::vector<page_id_t> *page_ids) {
+  std::shared_lock s_lock(global_latch_);
+  // Frames only change their page under the exclusive latch. Claimed frames are being loaded, evicted or deleted.
+  std::vector<frame_id_t> frame_ids;
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].pin_count_ >= 0) {
+      frame_ids.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+  replacer_->SortByHotness(&frame_ids);
+  page_ids->reserve(frame_ids.size());
+  for (const frame_id_t frame_id : frame_ids) {
+    page_ids->push_back(pages_[frame_id].page_id_);
+  }
+}
+
+void BufferPoolManager::WaitForWarmup() {
+  if (warmup_thread_ != nullptr) {
+    warmup_thread_->join();
+    delete warmup_thread_;
+    warmup_thread_ = nullptr;
+  }
+}
+
+void BufferPoolManager::Prefetch(page_id_t page_id) { PrefetchRange(page_id, 1); }
+
+void BufferPoolManager::PrefetchRange(page_id_t first_page_id, size_t num_pages) {
+  assert(first_page_id != INVALID_PAGE_ID);
+  std::call_once(prefetch_thread_started_, [this] {
+    prefetch_thread_ = new std::thread([this] {
+      std::unique_lock<std::mutex> lock(prefetch_latch_);
+      while (true) {
+        prefetch_cv_.wait(lock, [this] { return stop_prefetch_ || !prefetch_queue_.empty(); });
+        if (stop_prefetch_) {
+          return;
+        }
+        // Everything queued meanwhile is loaded as one batch.
+        std::vector<page_id_t> page_ids(prefetch_queue_.begin(), prefetch_queue_.end());
+        prefetch_queue_.clear();
+        lock.unlock();
+        LoadPrefetched(page_ids);
+        lock.lock();
+      }
+    });
+  });
+  // Never prefetch a page which was not allocated yet, it would be read as garbage.
+  const auto num_allocated = static_cast<size_t>(disk_manager_->GetNumAllocatedPages());
+  const size_t end = std::min(static_cast<size_t>(first_page_id) + num_pages, num_allocated);
+  {
+    std::lock_guard<std::mutex> lock(prefetch_latch_);
+    for (size_t page_id = first_page_id; page_id < end; page_id++) {
+      // Prefetching more than half of the pool would evict the prefetched pages before they are used.
+      if (prefetch_queue_.size() >= pool_size_ / 2) {
+        break;
+      }
+      prefetch_queue_.push_back(static_cast<page_id_t>(page_id));
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+size_t BufferPoolManager::GetNumPrefetches() {
+  size_t num = num_prefetches_;
+  for (auto shard : shards_) {
+    num += shard->GetNumPrefetches();
+  }
+  return num;
+}
+
+void BufferPoolManager::LoadPrefetched(const std::vector<page_id_t> &page_ids) {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  FetchPagesImpl(page_ids, pages.data(), true);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    if (pages[i] != nullptr) {
+      num_prefetches_++;
+      UnpinPageImpl(page_ids[i], false);
+    }
+  }
+}
+
+void BufferPoolManager::RunPageCleaner(double target_clean_ratio) {
+  assert(target_clean_ratio > 0 && target_clean_ratio <= 1);
+  if (!shards_.empty()) {
+    for (auto shard : shards_) {
+      shard->RunPageCleaner(target_clean_ratio);
+    }
+    return;
+  }
+  if (enable_page_cleaner_) {
+    return;
+  }
+  enable_page_cleaner_ = true;
+  page_cleaner_thread_ = new std::thread([this, target_clean_ratio] {
+    while (enable_page_cleaner_) {
+      {
+        std::unique_lock<std::mutex> lock(page_cleaner_latch_);
+        page_cleaner_cv_.wait_for(lock, page_cleaner_interval);
+      }
+      CleanFrames(target_clean_ratio);
+    }
+  });
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  if (!shards_.empty()) {
+    for (auto shard : shards_) {
+      shard->StopPageCleaner();
+    }
+    return;
+  }
+  if (page_cleaner_thread_ == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(page_cleaner_latch_);
+    enable_page_cleaner_ = false;
+  }
+  page_cleaner_cv_.notify_one();
+  page_cleaner_thread_->join();
+  delete page_cleaner_thread_;
+  page_cleaner_thread_ = nullptr;
+}
+
+size_t BufferPoolManager::GetNumEvictions() {
+  size_t num = num_evictions_;
+  for (auto shard : shards_) {
+    num += shard->GetNumEvictions();
+  }
+  return num;
+}
+
+size_t BufferPoolManager::GetNumForegroundWrites() {
+  size_t num = num_foreground_writes_;
+  for (auto shard : shards_) {
+    num += shard->GetNumForegroundWrites();
+  }
+  return num;
+}
+
+size_t BufferPoolManager::GetNumStagedWrites() {
+  size_t num = num_staged_writes_;
+  for (auto shard : shards_) {
+    num += shard->GetNumStagedWrites();
+  }
+  return num;
+}
+
+size_t BufferPoolManager::GetNumCleanerWrites() {
+  size_t num = num_cleaner_writes_;
+  for (auto shard : shards_) {
+    num += shard->GetNumCleanerWrites();
+  }
+  return num;
+}
+
+void BufferPoolManager::CleanFrames(double target_clean_ratio) {
+  const size_t pool_size = pool_size_;
+  const auto target = static_cast<size_t>(target_clean_ratio * pool_size);
+  size_t num_clean = 0;
+  // Walk the frames in the order the replacer will look at them. No latch is held: frame states read here are only
+  // hints, CleanFrame re-checks them under the page latch.
+  size_t frame_id = static_cast<size_t>(replacer_->NextVictimHint()) % pool_size;
+  for (size_t i = 0; i < pool_size && num_clean < target; i++, frame_id = (frame_id + 1) % pool_size) {
+    Page *const page = pages_ + frame_id;
+    const int pin_count = page->pin_count_;
+    if (pin_count > 0) {
+      // Pinned frames are no eviction candidates.
+      continue;
+    }
+    // Free frames and frames being evicted count as clean.
+    if (pin_count < 0 || !page->is_dirty_ || CleanFrame(page)) {
+      num_clean++;
+    }
+  }
+}
+
+bool BufferPoolManager::CleanFrame(Page *page) {
+  const page_id_t page_id = page->page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  page->RLatch();
+  // The frame may have been evicted, pinned or written back while no latch was held.
+  bool clean = page->page_id_ != page_id || page->pin_count_ != 0 || !page->is_dirty_;
+  // WAL: a page may only be written once its log records are persistent. Leave it to the log flush thread.
+  if (!clean && (!enable_logging || page->GetLSN() <= log_manager_->GetPersistentLSN())) {
+    page->is_dirty_ = false;
+    DropStagedWrite(page_id);
+    disk_manager_->WritePage(page_id, page->data_);
+    num_cleaner_writes_++;
+    clean = true;
+  }
+  page->RUnlatch();
+  return clean;
+}
+
+Page *BufferPoolManager::PinFrame(frame_id_t frame_id) {
+  Page *const page = pages_ + frame_id;
+  assert(page->pin_count_ >= 0);
+  if (page->pin_count_++ == 0) {
+    replacer_->Pin(frame_id);
+  }
+  return page;
+}
+
+Page *BufferPoolManager::TryPinFrame(frame_id_t frame_id, page_id_t page_id) {
+  Page *const page = pages_ + frame_id;
+  int pin_count = page->pin_count_.load();
+  do {
+    // The frame is free or claimed by an eviction or a deletion.
+    if (pin_count < 0) {
+      return nullptr;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // The frame may have been given to another page between the lookup and the pin.
+  if (page->page_id_ != page_id) {
+    UnpinFrame(frame_id);
+    return nullptr;
+  }
+  if (pin_count == 0) {
+    replacer_->Pin(frame_id);
+  }
+  return page;
+}
+
+bool BufferPoolManager::UnpinFrame(frame_id_t frame_id) {
+  Page *const page = pages_ + frame_id;
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) {
+    replacer_->Unpin(frame_id);
+  }
+  return true;
+}
+
+bool BufferPoolManager::PickVictim(frame_id_t *frame_id) {
+  // Pin and Unpin notifications arrive concurrently from lock-free hits and unpins. If the last unpin of a frame
+  // raced with a hit, the replacer may still hold the now pinned frame: drop it here, its page stays resident and its
+  // next unpin adds it back. Claiming the frame keeps lock-free hits away until the eviction has published the new
+  // page. Frames beyond the pool size are left to a shrinking Resize, which drains them.
+  // Latched victims are handed back to the replacer once the search is over, so that it does not return them again.
+  std::vector<frame_id_t> latched;
+  bool found = false;
+  while (!found && replacer_->Victim(frame_id)) {
+    int pin_count = 0;
+    if (static_cast<size_t>(*frame_id) >= pool_size_ ||
+        !pages_[*frame_id].pin_count_.compare_exchange_strong(pin_count, FRAME_CLAIMED)) {
+      replacer_->Reinstate(*frame_id);
+      continue;
+    }
+    found = pages_[*frame_id].TryWLatch();
+    if (!found) {
+      pages_[*frame_id].pin_count_ = 0;
+      replacer_->Reinstate(*frame_id);
+      latched.push_back(*frame_id);
+    }
+  }
+  for (const frame_id_t latched_frame_id : latched) {
+    int pin_count = 0;
+    if (!found && pages_[latched_frame_id].pin_count_.compare_exchange_strong(pin_count, FRAME_CLAIMED)) {
+      // Only latched victims are left: wait for one of them.
+      *frame_id = latched_frame_id;
+      pages_[latched_frame_id].WLatch();
+      found = true;
+    } else if (pin_count == 0) {
+      replacer_->Unpin(latched_frame_id);
+    }
+  }
+  return found;
+}
+
+bool BufferPoolManager::TakeStaleFrame(page_id_t page_id, frame_id_t *frame_id,
+                                       std::unique_lock<std::shared_mutex> *u_lock) {
+  // The stale copy may still be pinned: by the prefetch which is reading it, or, since page ids are reused, by anyone
+  // who fetched the id before it was deleted. Taking another frame would map the page id twice, so wait for the pin
+  // instead, without the latch: the pool keeps serving misses, and the holder of the pin may need the latch. Mappings
+  // only change under the latch, so the frame is looked up again once the latch is back.
+  while (page_table_.Find(page_id, frame_id)) {
+    int pin_count = 0;
+    if (pages_[*frame_id].pin_count_.compare_exchange_strong(pin_count, FRAME_CLAIMED)) {
+      assert(pages_[*frame_id].page_id_ == page_id);
+      // The stale copy was read, never written: FlushAllPages and the page cleaner do not latch it.
+      pages_[*frame_id].WLatch();
+      replacer_->Remove(*frame_id);
+      return true;
+    }
+    u_lock->unlock();
+    std::this_thread::yield();
+    u_lock->lock();
+  }
+  return false;
+}
+
+bool BufferPoolManager::TakeRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) {
+  page_id_t ring_page_id;
+  if (!strategy->NextSlot(this, frame_id, &ring_page_id)) {
+    return false;
+  }
+  // The ring frame may have been evicted and reused by another page, or the page may be pinned by another reader.
+  // Page ids only change under the exclusive latch, so the check holds until the frame is claimed.
+  Page *const page = pages_ + *frame_id;
+  int pin_count = 0;
+  if (static_cast<size_t>(*frame_id) >= pool_size_ || page->page_id_ != ring_page_id ||
+      !page->pin_count_.compare_exchange_strong(pin_count, FRAME_CLAIMED)) {
+    return false;
+  }
+  // A latched frame, e.g. one being written by FlushAllPages, is left alone rather than waited for.
+  if (!page->TryWLatch()) {
+    page->pin_count_ = 0;
+    return false;
+  }
+  replacer_->Remove(*frame_id);
+  return true;
+}
+
+Page *BufferPoolManager::Evict(page_id_t page_id, bool new_page, std::unique_lock<std::shared_mutex> *u_lock,
+                               BufferAccessStrategy *strategy, bool prefetch) {
+  page_id_t victim_page_id;
+  bool victim_dirty;
+  Page *const page = ClaimFrame(page_id, new_page, strategy, prefetch, &victim_page_id, &victim_dirty, u_lock);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  u_lock->unlock();
+  // 2.2.4.     If R is dirty and could not be staged, write it back to the disk.
+  if (victim_dirty) {
+    WriteBackVictim(page, victim_page_id, new_page);
+  }
+  // 2.2.5.     If not called by NewPage, read in the page content from its pending write-back or from disk.
+  //            A free frame is already zeroed.
+  if (!new_page) {
+    if (!ReadStaged(page)) {
+      disk_manager_->ReadPage(page_id, page->data_);
+    }
+  } else if (victim_page_id != INVALID_PAGE_ID) {
+    page->ResetMemory();
+  }
+  // 3.     Remember the frame in the ring of a bulk access, and return a pointer to P.
+  if (strategy != nullptr) {
+    strategy->Record(this, static_cast<frame_id_t>(page - pages_), page_id);
+  }
+  page->WUnlatch();
+  return page;
+}
+
+Page *BufferPoolManager::ClaimFrame(page_id_t page_id, bool new_page, BufferAccessStrategy *strategy, bool prefetch,
+                                    page_id_t *victim_page_id, bool *victim_dirty,
+                                    std::unique_lock<std::shared_mutex> *u_lock) {
   frame_id_t frame_r_id;
   Page *page = nullptr;
+  *victim_page_id = INVALID_PAGE_ID;
+  *victim_dirty = false;
   // 0      For Project4
   //       > In your BufferPoolManager, when a new page is created,
   //       > if there is already an entry in the page_table_ mapping for the given page id,
@@ -186,66 +1158,191 @@ Page *BufferPoolManager::Evict(page_id_t page_id, bool new_page, std::unique_loc
 //      goto last;
 //    }
 //  }
-  // 1      If P does not exist, find a replacement page (R) from either the free list or the replacer.
-  assert(!free_list_.empty() || replacer_->Size() != 0);
-  if (!free_list_.empty()) {
+  // 1      If P does not exist, find a replacement page (R) from the ring of a bulk access, the free list or the
+  //        replacer.
+  //        A new page may already have been prefetched while its id was being allocated: replace that copy.
+  const bool reuse_frame = (new_page && TakeStaleFrame(page_id, &frame_r_id, u_lock)) ||
+                         (strategy != nullptr && TakeRingFrame(strategy, &frame_r_id));
+  if (!reuse_frame && !free_list_.empty()) {
     // 2.1     always find from free list first
     frame_r_id = free_list_.front();
     free_list_.pop_front();
-    page_table_.emplace(page_id, frame_r_id);
+    page_table_.Insert(page_id, frame_r_id);
+    replacer_->Load(frame_r_id, page_id);
+    if (!prefetch) {
+      replacer_->Pin(frame_r_id);
+    }
     page = pages_ + frame_r_id;
     page->WLatch();
-    u_lock->unlock();
-    assert(page->pin_count_ == 0);
+    assert(page->pin_count_ == FRAME_CLAIMED);
     assert(!page->is_dirty_);
     assert(page->page_id_ == INVALID_PAGE_ID);
-    // 2.1.1     If not called by NewPage, then have to read the page into frame
-    if (!new_page) {
-      disk_manager_->ReadPage(page_id, page->data_);
-    }
-  } else {
-    // 2.2. then find from replacer
-    [[maybe_unused]] const bool victim_res = replacer_->Victim(&frame_r_id);
-    assert(victim_res);
-    page = pages_ + frame_r_id;
-    // 2.2.1.     Delete R from the page table and insert P.
-    page_table_.erase(page->page_id_);
-    page_table_.emplace(page_id, frame_r_id);
+    // 2.1.1     Update P's metadata before releasing the latch, a concurrent hit on P must see the pin.
+    page->page_id_ = page_id;
+    page->pin_count_ = 1;
+    // For Project 4 := new page is assumed always dirty, since the unpin can't be called at DBMS-Down-Time.
+    page->is_dirty_ = new_page;
+    return page;
+  }
+  // 2.2. then find from replacer
+  if (!reuse_frame && !PickVictim(&frame_r_id)) {
+    return nullptr;
+  }
+  page = pages_ + frame_r_id;
+  // 2.2.1.     Delete R from the page table, unswizzle the reference to R and insert P.
+  page_table_.Erase(page->page_id_);
+  UnswizzleFrame(frame_r_id);
+  page_table_.Insert(page_id, frame_r_id);
+  replacer_->Load(frame_r_id, page_id);
+  if (!prefetch) {
     replacer_->Pin(frame_r_id);
-    page->WLatch();
-    u_lock->unlock();
-    assert(page->pin_count_ == 0);
-    assert(page->page_id_ != INVALID_PAGE_ID);
-    // 2.2.2.     If R is dirty, write it back to the disk.
-    if (page->is_dirty_) {
-      // Project 4.
-      // Before your buffer pool manager evicts a dirty page from LRU replacer and write this page back to db file,
-      // it needs to flush logs up to pageLSN. You need to compare persistent_lsn_ (a member variable maintains
-      // by Log Manager) with your pageLSN. However unlike group commit, buffer pool can force log manager to flush log
-      // buffer, but still needs to wait for logs to be permanently stored before continue
-      if (new_page) {
-        if (enable_logging && log_manager_->GetPersistentLSN() < page->GetLSN()) {
-            LOG_INFO("BufferPoolManager::Evict := Evict a Dirty Page, Triggering a Flushing Log to Disk.");  // NOLINT
-            log_manager_->Flush(true);
-        }
-      }
-      disk_manager_->WritePage(page->page_id_, page->data_);
-//      page->is_dirty_ = false;
-    }
-    // 2.2.3.     If not called by NewPage, read in the page content from disk
-    if (!new_page) {
-      disk_manager_->ReadPage(page_id, page->data_);
-    } else {
-      page->ResetMemory();
-    }
   }
-//  last:
-  // 3.     Update P's metadata and then return a pointer to P.
+  // The frame was write latched when it was claimed.
+  assert(page->pin_count_ == FRAME_CLAIMED);
+  assert(page->page_id_ != INVALID_PAGE_ID);
+  // 2.2.2.     Remember R, then update P's metadata before releasing the latch.
+  *victim_page_id = page->page_id_;
+  *victim_dirty = page->is_dirty_;
+  // 2.2.3.     Stage a dirty R for asynchronous write-back, so that P can be loaded right away. A stale copy of a new
+  //            page, see TakeStaleFrame, is written back by the caller.
+  if (*victim_dirty && *victim_page_id != page_id && StageVictim(page, *victim_page_id)) {
+    *victim_dirty = false;
+  }
   page->page_id_ = page_id;
   page->pin_count_ = 1;
   // For Project 4 := new page is assumed always dirty, since the unpin can't be called at DBMS-Down-Time.
   page->is_dirty_ = new_page;
-  page->WUnlatch();
+  num_evictions_++;
   return page;
 }
+
+void BufferPoolManager::WriteBackVictim(Page *page, page_id_t victim_page_id, bool new_page) {
+  // The page cleaner did not keep up, wake it up.
+  num_foreground_writes_++;
+  page_cleaner_cv_.notify_one();
+  // Project 4.
+  // Before your buffer pool manager evicts a dirty page from LRU replacer and write this page back to db file,
+  // it needs to flush logs up to pageLSN. You need to compare persistent_lsn_ (a member variable maintains
+  // by Log Manager) with your pageLSN. However unlike group commit, buffer pool can force log manager to flush log
+  // buffer, but still needs to wait for logs to be permanently stored before continue
+  if (new_page) {
+    if (enable_logging && log_manager_->GetPersistentLSN() < page->GetLSN()) {
+        LOG_INFO("BufferPoolManager::Evict := Evict a Dirty Page, Triggering a Flushing Log to Disk.");  // NOLINT
+        log_manager_->Flush(true);
+    }
+  }
+  disk_manager_->WritePage(victim_page_id, page->data_);
+  // Misses of the victim read it from disk from now on.
+  std::lock_guard<std::mutex> lock(staging_latch_);
+  staged_writes_.erase(victim_page_id);
+  staging_cv_.notify_all();
+}
+
+bool BufferPoolManager::StageVictim(Page *page, page_id_t victim_page_id) {
+  if (num_staging_slots_ > 0) {
+    std::call_once(write_back_thread_started_,
+                   [this] { write_back_thread_ = new std::thread(&BufferPoolManager::WriteBackStaged, this); });
+  }
+  std::unique_lock<std::mutex> lock(staging_latch_);
+  // A victim fetched back from its staged copy may still have that write-back pending, see ReadStaged. A queued copy
+  // is replaced by the newer data, a copy being written is waited for, so that the writes of the page stay in order.
+  const auto it = staged_writes_.find(victim_page_id);
+  if (it != staged_writes_.end() && !it->second.in_flight_) {
+    memcpy(it->second.data_, page->data_, PAGE_SIZE);
+    it->second.lsn_ = page->GetLSN();
+    return true;
+  }
+  staging_cv_.wait(lock, [this, victim_page_id] { return staged_writes_.count(victim_page_id) == 0; });
+  if (free_staging_slots_.empty()) {
+    // The write-back thread does not keep up. The caller writes the victim back, misses copy it from the frame.
+    staged_writes_.emplace(victim_page_id, StagedWrite{page->data_, page->GetLSN(), true});
+    return false;
+  }
+  char *const slot = free_staging_slots_.back();
+  free_staging_slots_.pop_back();
+  memcpy(slot, page->data_, PAGE_SIZE);
+  staged_writes_.emplace(victim_page_id, StagedWrite{slot, page->GetLSN(), false});
+  staging_queue_.push_back(victim_page_id);
+  staging_cv_.notify_all();
+  // The page cleaner did not keep up, wake it up.
+  page_cleaner_cv_.notify_one();
+  return true;
+}
+
+bool BufferPoolManager::ReadStaged(Page *page) {
+  std::unique_lock<std::mutex> lock(staging_latch_);
+  const auto it = staged_writes_.find(page->page_id_);
+  if (it == staged_writes_.end()) {
+    return false;
+  }
+  memcpy(page->data_, it->second.data_, PAGE_SIZE);
+  if (!it->second.in_flight_) {
+    // The queued write stays, so the page comes back clean whether or not the write-back thread took it already.
+    return true;
+  }
+  // The page cannot be staged again meanwhile, it is in the caller's claimed frame.
+  staging_cv_.wait(lock, [this, page] { return staged_writes_.count(page->page_id_) == 0; });
+  return true;
+}
+
+void BufferPoolManager::DropStagedWrite(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(staging_latch_);
+  const auto it = staged_writes_.find(page_id);
+  if (it == staged_writes_.end()) {
+    return;
+  }
+  if (!it->second.in_flight_) {
+    free_staging_slots_.push_back(it->second.data_);
+    staged_writes_.erase(it);
+    return;
+  }
+  staging_cv_.wait(lock, [this, page_id] { return staged_writes_.count(page_id) == 0; });
+}
+
+void BufferPoolManager::WaitForStagedWrites(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(staging_latch_);
+  // Victims staged later are not waited for, they may keep coming while the pool is in use.
+  std::vector<page_id_t> page_ids;
+  if (page_id != INVALID_PAGE_ID) {
+    page_ids.push_back(page_id);
+  } else {
+    for (const auto &staged_write : staged_writes_) {
+      page_ids.push_back(staged_write.first);
+    }
+  }
+  for (const page_id_t staged_page_id : page_ids) {
+    staging_cv_.wait(lock, [this, staged_page_id] { return staged_writes_.count(staged_page_id) == 0; });
+  }
+}
+
+void BufferPoolManager::WriteBackStaged() {
+  std::unique_lock<std::mutex> lock(staging_latch_);
+  while (true) {
+    staging_cv_.wait(lock, [this] { return stop_write_back_ || !staging_queue_.empty(); });
+    if (staging_queue_.empty()) {
+      return;
+    }
+    const page_id_t page_id = staging_queue_.front();
+    staging_queue_.pop_front();
+    // A miss or a deletion of the page may have taken the copy back.
+    const auto it = staged_writes_.find(page_id);
+    if (it == staged_writes_.end() || it->second.in_flight_) {
+      continue;
+    }
+    it->second.in_flight_ = true;
+    char *const data = it->second.data_;
+    const lsn_t lsn = it->second.lsn_;
+    lock.unlock();
+    // WAL: the log records of the victim have to be persistent before the victim is written.
+    if (enable_logging && log_manager_->GetPersistentLSN() < lsn) {
+      log_manager_->Flush(true);
+    }
+    disk_manager_->WritePage(page_id, data);
+    num_staged_writes_++;
+    lock.lock();
+    staged_writes_.erase(page_id);
+    free_staging_slots_.push_back(data);
+    staging_cv_.notify_all();
+  }
+}
 }  // namespace bustub
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.cpp
+//
+// Identification: src/buffer/concurrent_page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/concurrent_page_table.h"
+
+#include <cassert>
+
+namespace bustub {
+
+ConcurrentPageTable::SlotArray::SlotArray(size_t capacity)
+    : mask_(capacity - 1), slots_(new std::atomic<slot_t>[capacity]) {
+  for (size_t i = 0; i < capacity; i++) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+ConcurrentPageTable::SlotArray::~SlotArray() { delete[] slots_; }
+
+ConcurrentPageTable::ConcurrentPageTable(size_t num_frames)
+    : capacity_([num_frames]() {
+        // Keep the load factor of live entries at most 1/2, with a power of two for masking.
+        size_t capacity = 4;
+        while (capacity < 2 * num_frames) {
+          capacity <<= 1;
+        }
+        return capacity;
+      }()),
+      slots_(new SlotArray(capacity_)) {}
+
+ConcurrentPageTable::~ConcurrentPageTable() { delete slots_.load(); }
+
+bool ConcurrentPageTable::Find(page_id_t page_id, frame_id_t *frame_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  const auto ticket = epoch_manager_.Enter();
+  const SlotArray *const slots = slots_.load(std::memory_order_acquire);
+  bool found = false;
+  for (size_t i = HashOf(page_id) & slots->mask_;; i = (i + 1) & slots->mask_) {
+    const slot_t slot = slots->slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY) {
+      break;
+    }
+    if (slot != TOMBSTONE && PageOf(slot) == page_id) {
+      *frame_id = FrameOf(slot);
+      found = true;
+      break;
+    }
+  }
+  epoch_manager_.Exit(ticket);
+  return found;
+}
+
+void ConcurrentPageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  SlotArray *const slots = slots_.load(std::memory_order_relaxed);
+  std::atomic<slot_t> *target = nullptr;
+  for (size_t i = HashOf(page_id) & slots->mask_;; i = (i + 1) & slots->mask_) {
+    const slot_t slot = slots->slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      if (target == nullptr) {
+        target = &slots->slots_[i];
+        used_++;
+      }
+      break;
+    }
+    if (slot == TOMBSTONE) {
+      // Reuse the first tombstone, but keep probing in case the page is already present further down the chain.
+      if (target == nullptr) {
+        target = &slots->slots_[i];
+      }
+      continue;
+    }
+    if (PageOf(slot) == page_id) {
+      slots->slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+  target->store(MakeSlot(page_id, frame_id), std::memory_order_release);
+  size_++;
+  if (used_ * 4 > capacity_ * 3) {
+    Rebuild();
+  }
+}
+
+bool ConcurrentPageTable::Erase(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  SlotArray *const slots = slots_.load(std::memory_order_relaxed);
+  for (size_t i = HashOf(page_id) & slots->mask_;; i = (i + 1) & slots->mask_) {
+    const slot_t slot = slots->slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      return false;
+    }
+    if (slot != TOMBSTONE && PageOf(slot) == page_id) {
+      slots->slots_[i].store(TOMBSTONE, std::memory_order_release);
+      size_--;
+      return true;
+    }
+  }
+}
+
+void ConcurrentPageTable::Rebuild() {
+  SlotArray *const old_slots = slots_.load(std::memory_order_relaxed);
+  auto *const new_slots = new SlotArray(capacity_);
+  used_ = 0;
+  for (size_t i = 0; i < capacity_; i++) {
+    const slot_t slot = old_slots->slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY || slot == TOMBSTONE) {
+      continue;
+    }
+    size_t j = HashOf(PageOf(slot)) & new_slots->mask_;
+    while (new_slots->slots_[j].load(std::memory_order_relaxed) != EMPTY) {
+      j = (j + 1) & new_slots->mask_;
+    }
+    new_slots->slots_[j].store(slot, std::memory_order_relaxed);
+    used_++;
+  }
+  slots_.store(new_slots, std::memory_order_release);
+  // Readers which loaded the old array entered before the epoch advance, wait for them before freeing it.
+  epoch_manager_.WaitForReaders();
+  delete old_slots;
+}
+
+}  // namespace bustub
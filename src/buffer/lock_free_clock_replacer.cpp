@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lock_free_clock_replacer.cpp
+//
+// Identification: src/buffer/lock_free_clock_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lock_free_clock_replacer.h"
+
+#include <cassert>
+
+namespace bustub {
+
+LockFreeClockReplacer::LockFreeClockReplacer(size_t num_pages)
+    : num_pages_(num_pages),
+      num_frames_(num_pages),
+      bitmap_(new std::atomic<word_t>[(num_pages + FRAMES_PER_WORD - 1) / FRAMES_PER_WORD]) {
+  for (size_t i = 0; i < (num_pages + FRAMES_PER_WORD - 1) / FRAMES_PER_WORD; i++) {
+    bitmap_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+LockFreeClockReplacer::~LockFreeClockReplacer() = default;
+
+bool LockFreeClockReplacer::Victim(frame_id_t *frame_id) {
+  size_t hand = clock_hand_.load();
+  const size_t num_frames = num_frames_.load();
+  for (size_t i = 0; i < MAX_SWEEPS * num_frames; i++) {
+    if (size_.load() <= 0) {
+      return false;
+    }
+    const auto candidate = static_cast<frame_id_t>(hand % num_frames);
+    std::atomic<word_t> &word = WordOf(candidate);
+    const word_t exist_bit = ExistBit(candidate);
+    const word_t ref_bit = RefBit(candidate);
+    word_t flags = word.load();
+    while ((flags & exist_bit) != 0) {
+      if ((flags & ref_bit) != 0) {
+        // Second chance. Losing the race to a concurrent Pin or Unpin is fine, the frame is skipped either way.
+        word.fetch_and(~ref_bit);
+        break;
+      }
+      // Only evict the frame if it is still unreferenced, a failed CAS reloads the flags and retries.
+      if (word.compare_exchange_weak(flags, flags & ~exist_bit)) {
+        // Like ClockReplacer, the hand stays on the victim.
+        size_.fetch_sub(1);
+        *frame_id = candidate;
+        return true;
+      }
+    }
+    // Advance the hand past the candidate, unless a concurrent Victim moved it already, then continue from there.
+    if (clock_hand_.compare_exchange_strong(hand, hand + 1)) {
+      hand++;
+    }
+  }
+  return false;
+}
+
+void LockFreeClockReplacer::Pin(frame_id_t frame_id) {
+  assert(static_cast<size_t>(frame_id) < num_pages_);
+  const word_t flags = WordOf(frame_id).fetch_and(~(ExistBit(frame_id) | RefBit(frame_id)));
+  if ((flags & ExistBit(frame_id)) != 0) {
+    size_.fetch_sub(1);
+  }
+}
+
+void LockFreeClockReplacer::Unpin(frame_id_t frame_id) {
+  assert(static_cast<size_t>(frame_id) < num_pages_);
+  const word_t flags = WordOf(frame_id).fetch_or(ExistBit(frame_id) | RefBit(frame_id));
+  if ((flags & ExistBit(frame_id)) == 0) {
+    size_.fetch_add(1);
+  }
+}
+
+size_t LockFreeClockReplacer::Size() {
+  // A Pin racing with the Unpin of the same frame may decrement the counter before it was incremented.
+  const int64_t size = size_.load();
+  return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+}  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period)
+    : k_(k), correlated_period_(correlated_period), frames_(num_pages) {
+  assert(k_ > 0);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+LRUKReplacer::evict_key_t LRUKReplacer::EvictKeyOf(frame_id_t frame_id) const {
+  const FrameInfo &info = frames_[frame_id];
+  // history_ holds at most K references, so its front is the K-th most recent one once the frame has K references.
+  const uint64_t oldest = info.history_.empty() ? info.last_ : info.history_.front();
+  return {info.history_.size() >= k_, oldest, frame_id};
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  // Skip frames whose last reference is still within the correlated period, unless there are only such frames.
+  auto victim = evictable_.begin();
+  for (auto it = victim; it != evictable_.end(); ++it) {
+    if (current_timestamp_ - frames_[std::get<2>(*it)].last_ >= correlated_period_) {
+      victim = it;
+      break;
+    }
+  }
+  *frame_id = std::get<2>(*victim);
+  evictable_.erase(victim);
+  // The history stays until Load: if the buffer pool reinstates the frame, its page keeps its rank.
+  frames_[*frame_id].evictable_ = false;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    evictable_.erase(EvictKeyOf(frame_id));
+    info.evictable_ = false;
+  }
+  const uint64_t now = ++current_timestamp_;
+  // A correlated reference only refreshes the last reference.
+  if (info.history_.empty() || now - info.last_ > correlated_period_) {
+    info.history_.push_back(now);
+    if (info.history_.size() > k_) {
+      info.history_.pop_front();
+    }
+  }
+  info.last_ = now;
+}
+
+void LRUKReplacer::Load(frame_id_t frame_id, [[maybe_unused]] page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  // The frame got a new page, the history of the old one is meaningless for it.
+  FrameInfo &info = frames_[frame_id];
+  info.history_.clear();
+  info.last_ = current_timestamp_;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  FrameInfo &info = frames_[frame_id];
+  if (!info.evictable_) {
+    info.evictable_ = true;
+    evictable_.insert(EvictKeyOf(frame_id));
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(static_cast<size_t>(frame_id) < frames_.size());
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    evictable_.erase(EvictKeyOf(frame_id));
+    info.evictable_ = false;
+  }
+  info.history_.clear();
+}
+
+size_t LRUKReplacer::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return evictable_.size();
+}
+
+frame_id_t LRUKReplacer::NextVictimHint() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return evictable_.empty() ? 0 : std::get<2>(*evictable_.begin());
+}
+
+void LRUKReplacer::SortByHotness(std::vector<frame_id_t> *frame_ids) {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::sort(frame_ids->begin(), frame_ids->end(),
+            [this](frame_id_t a, frame_id_t b) { return EvictKeyOf(a) > EvictKeyOf(b); });
+}
+
+}  // namespace bustub
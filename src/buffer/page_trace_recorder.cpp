@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_trace_recorder.cpp
+//
+// Identification: src/buffer/page_trace_recorder.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_trace_recorder.h"
+
+namespace bustub {
+
+PageTraceRecorder::~PageTraceRecorder() { Stop(); }
+
+bool PageTraceRecorder::Start(const std::string &file_name) {
+  Stop();
+  std::lock_guard<std::mutex> guard(latch_);
+  file_.open(file_name, std::ios::binary | std::ios::out | std::ios::trunc);
+  if (!file_.is_open()) {
+    return false;
+  }
+  buffer_.reserve(BUFFER_SIZE);
+  start_ = std::chrono::steady_clock::now();
+  recording_ = true;
+  return true;
+}
+
+void PageTraceRecorder::Stop() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (!file_.is_open()) {
+    return;
+  }
+  recording_ = false;
+  WriteBuffer();
+  file_.close();
+}
+
+void PageTraceRecorder::Record(page_id_t page_id, PageTraceOp op) {
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(latch_);
+  if (!file_.is_open()) {
+    return;
+  }
+  const auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count();
+  buffer_.push_back({static_cast<uint64_t>(timestamp), page_id, op});
+  if (buffer_.size() == BUFFER_SIZE) {
+    WriteBuffer();
+  }
+}
+
+void PageTraceRecorder::WriteBuffer() {
+  file_.write(reinterpret_cast<const char *>(buffer_.data()),
+              static_cast<std::streamsize>(buffer_.size() * sizeof(PageTraceRecord)));
+  buffer_.clear();
+}
+
+bool PageTraceRecorder::ReadTrace(const std::string &file_name, std::vector<PageTraceRecord> *trace) {
+  std::ifstream file(file_name, std::ios::binary | std::ios::in | std::ios::ate);
+  if (!file.is_open()) {
+    return false;
+  }
+  const auto file_size = static_cast<size_t>(file.tellg());
+  if (file_size % sizeof(PageTraceRecord) != 0) {
+    return false;
+  }
+  trace->resize(file_size / sizeof(PageTraceRecord));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(trace->data()), static_cast<std::streamsize>(file_size));
+  return static_cast<bool>(file);
+}
+
+}  // namespace bustub
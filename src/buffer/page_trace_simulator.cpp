@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_trace_simulator.cpp
+//
+// Identification: src/buffer/page_trace_simulator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_trace_simulator.h"
+
+#include <cassert>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace bustub {
+
+PageTraceSimulator::PageTraceSimulator(std::vector<PageTraceRecord> trace) : trace_(std::move(trace)) {
+  std::unordered_set<page_id_t> pages;
+  for (const auto &record : trace_) {
+    pages.insert(record.page_id_);
+  }
+  num_distinct_pages_ = pages.size();
+}
+
+double PageTraceSimulator::MissRatio(BufferPoolManager::ReplacerType replacer_type, size_t pool_size) const {
+  assert(pool_size > 0);
+  std::unique_ptr<Replacer> replacer(BufferPoolManager::MakeReplacer(replacer_type, pool_size));
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_pages(pool_size, INVALID_PAGE_ID);
+  size_t num_used_frames = 0;
+  size_t num_fetches = 0;
+  size_t num_misses = 0;
+
+  for (const auto &record : trace_) {
+    num_fetches += record.op_ == PageTraceOp::FETCH ? 1 : 0;
+    auto it = page_table.find(record.page_id_);
+    frame_id_t frame_id;
+    if (it != page_table.end()) {
+      frame_id = it->second;
+    } else {
+      num_misses += record.op_ == PageTraceOp::FETCH ? 1 : 0;
+      // Take a free frame, or evict. Every frame is unpinned between references, so there always is a victim.
+      if (num_used_frames < pool_size) {
+        frame_id = static_cast<frame_id_t>(num_used_frames++);
+      } else {
+        [[maybe_unused]] const bool found = replacer->Victim(&frame_id);
+        assert(found);
+        page_table.erase(frame_pages[frame_id]);
+      }
+      frame_pages[frame_id] = record.page_id_;
+      page_table.emplace(record.page_id_, frame_id);
+      replacer->Load(frame_id, record.page_id_);
+    }
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+  }
+  return num_fetches == 0 ? 0 : static_cast<double>(num_misses) / static_cast<double>(num_fetches);
+}
+
+std::vector<double> PageTraceSimulator::MissRatioCurve(BufferPoolManager::ReplacerType replacer_type,
+                                                       const std::vector<size_t> &pool_sizes) const {
+  std::vector<double> miss_ratios;
+  miss_ratios.reserve(pool_sizes.size());
+  for (size_t pool_size : pool_sizes) {
+    miss_ratios.push_back(MissRatio(replacer_type, pool_size));
+  }
+  return miss_ratios;
+}
+
+}  // namespace bustub
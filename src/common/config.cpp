@@ -20,4 +20,16 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(10);
+
+size_t table_read_ahead_pages = 8;
+
+bool buffer_pool_huge_pages = false;
+
+bool enable_pointer_swizzling = false;
+
+size_t write_back_staging_pages = 16;
+
+bool enable_io_uring = true;
+
 }  // namespace bustub
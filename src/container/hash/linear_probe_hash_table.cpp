@@ -50,6 +50,7 @@ HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager
     buffer_pool_manager_->NewPage(&page_id);
     buffer_pool_manager_->UnpinPage(page_id, false);
     page_ids_cache.emplace_back(page_id);
+    block_page_refs_.emplace_back(page_id);
   }
 
   // add block page id to the header page
@@ -64,6 +65,17 @@ HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager
   // TODO(jigao): cold start and hot sstart 进行区分
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_TYPE::~LinearProbeHashTable() {
+  // The buffer pool points to swizzled references until they are unswizzled. References which were never swizzled
+  // do not touch the buffer pool, which may be gone already.
+  for (auto &ref : block_page_refs_) {
+    if (ref.IsSwizzled()) {
+      buffer_pool_manager_->Unswizzle(&ref);
+    }
+  }
+}
+
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -77,35 +89,65 @@ bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
   const slot_offset_t slot_offset_start = page_postion.second;
   size_t page_index = page_postion.first;
   slot_offset_t slot_offset = page_postion.second;
-  auto bpm_page = buffer_pool_manager_->FetchPage(page_ids_cache[page_index]);
-  bpm_page->RLatch();
-  auto block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator>*>(bpm_page->GetData());
-  while (block_page->IsOccupied(slot_offset)) {
-    if (block_page->IsReadable(slot_offset)
-        && comparator_(key, block_page->KeyAt(slot_offset)) == 0) {
-      result->emplace_back(block_page->ValueAt(slot_offset));
+  while (true) {
+    auto bpm_page = FetchBlockPage(page_index);
+    auto block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator>*>(bpm_page->GetData());
+    // Probe the block page optimistically, its matches only count once the page version validates.
+    const size_t result_size = result->size();
+    bool probe_done = false;
+    bool valid = false;
+    for (int attempt = 0; attempt < OPTIMISTIC_READ_ATTEMPTS && !valid; attempt++) {
+      result->erase(result->begin() + result_size, result->end());
+      const uint64_t version = bpm_page->BeginOptimisticRead();
+      probe_done = ProbeBlock(block_page, page_index, slot_offset, page_index_start, slot_offset_start, key, result);
+      valid = bpm_page->ValidateRead(version);
     }
-    // SAME SAME SAME
-    if (++slot_offset == ((page_index == page_number - 1) ? BLOCK_ARRAY_SIZE_LAST_PAGE : BLOCK_ARRAY_SIZE_PRO_PAGE)) {
-      slot_offset = 0;
-      bpm_page->RUnlatch();
-      buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
-      if (++page_index == page_number) {
-        page_index = 0;
-      }
-      bpm_page = buffer_pool_manager_->FetchPage(page_ids_cache[page_index]);
+    if (!valid) {
+      result->erase(result->begin() + result_size, result->end());
       bpm_page->RLatch();
-      block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator>*>(bpm_page->GetData());
+      probe_done = ProbeBlock(block_page, page_index, slot_offset, page_index_start, slot_offset_start, key, result);
+      bpm_page->RUnlatch();
+    }
+    UnpinBlockPage(bpm_page, false);
+    if (probe_done) {
+      break;
+    }
+    // SAME SAME SAME
+    slot_offset = 0;
+    if (++page_index == page_number) {
+      page_index = 0;
     }
     if (page_index_start == page_index && slot_offset_start == slot_offset) {
       break;
     }
   }
-  bpm_page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
   table_latch_.RUnlock();
   return !result->empty();
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::ProbeBlock(HashTableBlockPage<KeyType, ValueType, KeyComparator> *block_page, size_t page_index,
+                                 slot_offset_t slot_offset, size_t page_index_start, slot_offset_t slot_offset_start,
+                                 const KeyType &key, std::vector<ValueType> *result) {
+  const slot_offset_t block_size =
+      (page_index == page_number - 1) ? BLOCK_ARRAY_SIZE_LAST_PAGE : BLOCK_ARRAY_SIZE_PRO_PAGE;
+  while (slot_offset < block_size) {
+    if (!block_page->IsOccupied(slot_offset)) {
+      return true;
+    }
+    const MappingType *const mapping = block_page->MappingAt(slot_offset);
+    if (mapping != nullptr) {
+      const MappingType slot = *mapping;
+      if (comparator_(key, slot.first) == 0) {
+        result->emplace_back(slot.second);
+      }
+    }
+    if (++slot_offset == slot_offset_start && page_index == page_index_start) {
+      return true;
+    }
+  }
+  return false;
+}
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -118,7 +160,7 @@ bool HASH_TABLE_TYPE::Insert_Helper(Transaction *transaction, const KeyType &key
   const slot_offset_t slot_offset_start = page_postion.second;
   size_t page_index = page_postion.first;
   slot_offset_t slot_offset = page_postion.second;
-  auto bpm_page = buffer_pool_manager_->FetchPage(page_ids_cache[page_index]);
+  auto bpm_page = FetchBlockPage(page_index);
   bpm_page->WLatch();
   auto block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator>*>(bpm_page->GetData());
   // TODO(jigao): 记录第一个墓碑　看微信聊天记录
@@ -127,29 +169,29 @@ bool HASH_TABLE_TYPE::Insert_Helper(Transaction *transaction, const KeyType &key
         && comparator_(key, block_page->KeyAt(slot_offset)) == 0
         && value == block_page->ValueAt(slot_offset)) {
       bpm_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
+      UnpinBlockPage(bpm_page, false);
       return false;
     }
     // SAME SAME SAME
     if (++slot_offset == ((page_index == page_number - 1) ? BLOCK_ARRAY_SIZE_LAST_PAGE : BLOCK_ARRAY_SIZE_PRO_PAGE)) {
       slot_offset = 0;
       bpm_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
+      UnpinBlockPage(bpm_page, false);
       if (++page_index == page_number) {
         page_index = 0;
       }
-      bpm_page = buffer_pool_manager_->FetchPage(page_ids_cache[page_index]);
+      bpm_page = FetchBlockPage(page_index);
       bpm_page->WLatch();
       block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator>*>(bpm_page->GetData());
     }
     if (page_index_start == page_index && slot_offset_start == slot_offset) {
       bpm_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
+      UnpinBlockPage(bpm_page, false);
       throw hash_table_full_error{};
     }
   }
   bpm_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], true);
+  UnpinBlockPage(bpm_page, true);
   return true;
 }
 
@@ -180,7 +222,7 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
   const slot_offset_t slot_offset_start = page_postion.second;
   size_t page_index = page_postion.first;
   slot_offset_t slot_offset = page_postion.second;
-  auto bpm_page = buffer_pool_manager_->FetchPage(page_ids_cache[page_index]);
+  auto bpm_page = FetchBlockPage(page_index);
   bpm_page->WLatch();
   auto block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator>*>(bpm_page->GetData());
   while (block_page->IsOccupied(slot_offset)) {
@@ -189,7 +231,7 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
         && value == block_page->ValueAt(slot_offset)) {
       block_page->Remove(slot_offset);
       bpm_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
+      UnpinBlockPage(bpm_page, true);
       table_latch_.RUnlock();
       return true;
     }
@@ -197,11 +239,11 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
     if (++slot_offset == ((page_index == page_number - 1) ? BLOCK_ARRAY_SIZE_LAST_PAGE : BLOCK_ARRAY_SIZE_PRO_PAGE)) {
       slot_offset = 0;
       bpm_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
+      UnpinBlockPage(bpm_page, false);
       if (++page_index == page_number) {
         page_index = 0;
       }
-      bpm_page = buffer_pool_manager_->FetchPage(page_ids_cache[page_index]);
+      bpm_page = FetchBlockPage(page_index);
       bpm_page->WLatch();
       block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator>*>(bpm_page->GetData());
     }
@@ -210,7 +252,7 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
     }
   }
   bpm_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
+  UnpinBlockPage(bpm_page, false);
   table_latch_.RUnlock();
   return false;
 }
@@ -228,7 +270,7 @@ void HASH_TABLE_TYPE::Resize(size_t initial_size) {
 //  pair_cache.reserve()
   assert(page_number == page_ids_cache.size());
   for (size_t page_index = 0; page_index < page_number; page_index++) {
-    auto bpm_page = buffer_pool_manager_->FetchPage(page_ids_cache[page_index]);
+    auto bpm_page = FetchBlockPage(page_index);
     bpm_page->RLatch();
     auto block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator>*>(bpm_page->GetData());
     for (slot_offset_t slot_offset = 0;
@@ -240,7 +282,7 @@ void HASH_TABLE_TYPE::Resize(size_t initial_size) {
       }
     }
     bpm_page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_ids_cache[page_index], false);
+    UnpinBlockPage(bpm_page, true);
   }
 
   // 2. Resize
@@ -257,6 +299,7 @@ void HASH_TABLE_TYPE::Resize(size_t initial_size) {
   for (size_t i = 0; i < page_number - old_page_number; i++) {
     buffer_pool_manager_->NewPage(&page_id);
     page_ids_cache.emplace_back(page_id);
+    block_page_refs_.emplace_back(page_id);
     buffer_pool_manager_->UnpinPage(page_id, false);
   }
 
@@ -9,10 +9,13 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
+#include "common/exception.h"
 #include "execution/executors/hash_join_executor.h"
 
 namespace bustub {
@@ -28,6 +31,12 @@ HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlan
   assert(right_executor_ != nullptr);
 }
 
+HashJoinExecutor::~HashJoinExecutor() {
+  for (page_id_t tmp_tuple_page_id : tmp_tuple_page_ids_) {
+    exec_ctx_->GetBufferPoolManager()->DeletePage(tmp_tuple_page_id);
+  }
+}
+
 void HashJoinExecutor::Init() {}
 
 bool HashJoinExecutor::Next(Tuple *tuple) {
@@ -38,12 +47,6 @@ bool HashJoinExecutor::Next(Tuple *tuple) {
   const Schema *left_output_schema = left_plan->OutputSchema();
   const AbstractPlanNode *right_plan = plan_->GetRightPlan();
   const Schema *right_output_schema = right_plan->OutputSchema();
-  // 0.2. predicate
-  const AbstractExpression *predicate = plan_->GetPredicate();
-  // 0.3. OUTPUT SCHEMA: output stuff
-  const Schema *final_output_schema = plan_->OutputSchema();
-  const uint32_t final_output_schema_col_count = final_output_schema->GetColumnCount();
-  const std::vector<Column> &final_output_cols = final_output_schema->GetColumns();
 
   // 1. if hash table not been built, then buld hash table using left tuples
   //    => pipeline breaker, blocked until left child empty
@@ -52,8 +55,9 @@ bool HashJoinExecutor::Next(Tuple *tuple) {
     // 1.0. new a tmp_tuple_page
     page_id_t tmp_tuple_page_id_;
     auto bpm_tmp_tuple_page = exec_ctx_->GetBufferPoolManager()->NewPage(&tmp_tuple_page_id_);
+    tmp_tuple_page_ids_.push_back(tmp_tuple_page_id_);
     bpm_tmp_tuple_page->WLatch();
-    auto tmp_tuple_page = reinterpret_cast<TmpTuplePage *>(bpm_tmp_tuple_page->GetData());
+    auto tmp_tuple_page = reinterpret_cast<TmpTuplePage *>(bpm_tmp_tuple_page);
     tmp_tuple_page->Init(tmp_tuple_page_id_, PAGE_SIZE);
     // 1.1. Get tuple from left side, insert into tmp_tuple_page
     TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
@@ -63,8 +67,9 @@ bool HashJoinExecutor::Next(Tuple *tuple) {
         bpm_tmp_tuple_page->WUnlatch();
         exec_ctx_->GetBufferPoolManager()->UnpinPage(tmp_tuple_page_id_, true);
         bpm_tmp_tuple_page = exec_ctx_->GetBufferPoolManager()->NewPage(&tmp_tuple_page_id_);
+        tmp_tuple_page_ids_.push_back(tmp_tuple_page_id_);
         bpm_tmp_tuple_page->WLatch();
-        tmp_tuple_page = reinterpret_cast<TmpTuplePage *>(bpm_tmp_tuple_page->GetData());
+        tmp_tuple_page = reinterpret_cast<TmpTuplePage *>(bpm_tmp_tuple_page);
         tmp_tuple_page->Init(tmp_tuple_page_id_, PAGE_SIZE);
         [[maybe_unused]] bool tmp_insert_res = tmp_tuple_page->Insert(t, &tmp_tuple);
         assert(tmp_insert_res);
@@ -88,6 +93,7 @@ bool HashJoinExecutor::Next(Tuple *tuple) {
   }
 
   // 2.1. generate right tuple(s) until joined
+  BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
   Tuple right_tuple_match;
   while (right_executor_->Next(&right_tuple_match)) {  // NOLINT
     // 2.2. probe hash table
@@ -95,32 +101,85 @@ bool HashJoinExecutor::Next(Tuple *tuple) {
     std::vector<TmpTuple> left_tmp_tuple_matches;
     jht_.GetValue(exec_ctx_->GetTransaction(), hash_value, &left_tmp_tuple_matches);
     assert(!left_tmp_tuple_matches.empty());
-    for (const auto& left_tmp_tuple_match : left_tmp_tuple_matches) {
-      // 2.3. re-construct tuple from tmp_tuple_page
-      Tuple left_tuple_match;
-      auto bpm_tmp_tuple_page = exec_ctx_->GetBufferPoolManager()->FetchPage(left_tmp_tuple_match.GetPageId());
-      bpm_tmp_tuple_page->RLatch();
-      left_tuple_match.DeserializeFrom(bpm_tmp_tuple_page->GetData() + left_tmp_tuple_match.GetOffset());
-      bpm_tmp_tuple_page->RUnlatch();
-      exec_ctx_->GetBufferPoolManager()->UnpinPage(left_tmp_tuple_match.GetPageId(), false);
-      // 2.4. evaluate join predicate using tuples
-      if ((predicate != nullptr) ?
-           predicate->EvaluateJoin(&left_tuple_match, left_output_schema,
-                                   &right_tuple_match, right_output_schema).GetAs<bool>()
-         : true) {
-        // 2.5. ONLY one hash key matched and joined, build output tuple
-        std::vector<Value> output_values;
-        output_values.reserve(final_output_schema_col_count);
-        for (size_t i = 0; i < final_output_schema_col_count; i++) {
-          output_values.emplace_back
-            (final_output_cols[i].GetExpr()->EvaluateJoin(&left_tuple_match, left_output_schema,
-                                                          &right_tuple_match, right_output_schema));
+    // 2.3. walk the matches in order, fetching the tmp_tuple_pages of a run of matches with one batched fetch. A run
+    //      holds at most as many distinct pages as the buffer pool has free or evictable frames.
+    bool joined = false;
+    size_t run_end;
+    for (size_t run_begin = 0; run_begin < left_tmp_tuple_matches.size() && !joined; run_begin = run_end) {
+      const size_t max_run_pages = std::max<size_t>(1, bpm->GetFreeListSize() + bpm->GetReplacerSize());
+      std::unordered_map<page_id_t, Page *> bpm_tmp_tuple_pages;
+      std::vector<page_id_t> tmp_tuple_page_ids;
+      for (run_end = run_begin; run_end < left_tmp_tuple_matches.size(); run_end++) {
+        const page_id_t tmp_tuple_page_id = left_tmp_tuple_matches[run_end].GetPageId();
+        if (bpm_tmp_tuple_pages.count(tmp_tuple_page_id) == 0) {
+          if (tmp_tuple_page_ids.size() == max_run_pages) {
+            break;
+          }
+          bpm_tmp_tuple_pages.emplace(tmp_tuple_page_id, nullptr);
+          tmp_tuple_page_ids.push_back(tmp_tuple_page_id);
+        }
+      }
+      std::vector<Page *> fetched_pages(tmp_tuple_page_ids.size());
+      if (bpm->FetchPages(tmp_tuple_page_ids, fetched_pages.data())) {
+        for (size_t i = 0; i < tmp_tuple_page_ids.size(); i++) {
+          bpm_tmp_tuple_pages[tmp_tuple_page_ids[i]] = fetched_pages[i];
+        }
+        // 2.4. evaluate join predicate using tuples
+        for (size_t i = run_begin; i < run_end && !joined; i++) {
+          joined = JoinTuples(bpm_tmp_tuple_pages[left_tmp_tuple_matches[i].GetPageId()], left_tmp_tuple_matches[i],
+                              right_tuple_match, tuple);
+        }
+        // 2.5. unpin the tmp_tuple_pages
+        for (page_id_t tmp_tuple_page_id : tmp_tuple_page_ids) {
+          bpm->UnpinPage(tmp_tuple_page_id, false);
         }
-        *tuple = Tuple(output_values, final_output_schema);
-        return true;
+        continue;
       }
+      // 2.6. the batch did not fit, frames were pinned by others meanwhile: fetch the pages of the run one by one
+      for (size_t i = run_begin; i < run_end && !joined; i++) {
+        const page_id_t tmp_tuple_page_id = left_tmp_tuple_matches[i].GetPageId();
+        Page *bpm_tmp_tuple_page = bpm->FetchPage(tmp_tuple_page_id);
+        if (bpm_tmp_tuple_page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "every frame is pinned, cannot fetch a tmp tuple page");
+        }
+        joined = JoinTuples(bpm_tmp_tuple_page, left_tmp_tuple_matches[i], right_tuple_match, tuple);
+        bpm->UnpinPage(tmp_tuple_page_id, false);
+      }
+    }
+    if (joined) {
+      return true;
     }
   }
   return false;
 }
+
+bool HashJoinExecutor::JoinTuples(Page *tmp_tuple_page, const TmpTuple &left_tmp_tuple, const Tuple &right_tuple,
+                                  Tuple *tuple) {
+  const Schema *left_output_schema = plan_->GetLeftPlan()->OutputSchema();
+  const Schema *right_output_schema = plan_->GetRightPlan()->OutputSchema();
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  // 1. re-construct tuple from tmp_tuple_page
+  Tuple left_tuple;
+  tmp_tuple_page->RLatch();
+  left_tuple.DeserializeFrom(tmp_tuple_page->GetData() + left_tmp_tuple.GetOffset());
+  tmp_tuple_page->RUnlatch();
+  if ((predicate != nullptr) ?
+       !predicate->EvaluateJoin(&left_tuple, left_output_schema, &right_tuple, right_output_schema).GetAs<bool>()
+     : false) {
+    return false;
+  }
+  // 2. ONLY one hash key matched and joined, build output tuple
+  const Schema *final_output_schema = plan_->OutputSchema();
+  const uint32_t final_output_schema_col_count = final_output_schema->GetColumnCount();
+  const std::vector<Column> &final_output_cols = final_output_schema->GetColumns();
+  std::vector<Value> output_values;
+  output_values.reserve(final_output_schema_col_count);
+  for (size_t i = 0; i < final_output_schema_col_count; i++) {
+    output_values.emplace_back
+      (final_output_cols[i].GetExpr()->EvaluateJoin(&left_tuple, left_output_schema,
+                                                    &right_tuple, right_output_schema));
+  }
+  *tuple = Tuple(output_values, final_output_schema);
+  return true;
+}
 }  // namespace bustub
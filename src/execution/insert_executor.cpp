@@ -36,6 +36,11 @@ bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple) {
   // 0.2. insert result as RID and bool
   RID rid;
   bool result = true;
+  // 0.3. a bulk insert writes through its own ring of frames
+  std::unique_ptr<BufferAccessStrategy> strategy;
+  if (exec_ctx_->IsBulkAccess()) {
+    strategy = std::make_unique<BufferAccessStrategy>(exec_ctx_->GetBufferPoolManager());
+  }
   // 1. insert all values at one Next function call
   if (plan_->IsRawInsert()) {
     // raw insert: directly insert values from plan, where tuple have to built using table schema
@@ -43,7 +48,8 @@ bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple) {
     assert(child_executor_ == nullptr);
     const std::vector<std::vector<Value>> &raw_vals = plan_->RawValues();
     for (const auto& raw_val : raw_vals) {
-      result &= table_heap->InsertTuple(Tuple(raw_val, table_schema), &rid, exec_ctx_->GetTransaction());
+      result &= table_heap->InsertTuple(Tuple(raw_val, table_schema), &rid, exec_ctx_->GetTransaction(),
+                                        strategy.get());
       assert(rid.GetPageId() != INVALID_PAGE_ID);
     }
   } else {
@@ -51,7 +57,7 @@ bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple) {
     assert(child_executor_ != nullptr);
     Tuple tuple_from_child;
     while (child_executor_->Next(&tuple_from_child)) {
-      result &= table_heap->InsertTuple(tuple_from_child, &rid, exec_ctx_->GetTransaction());
+      result &= table_heap->InsertTuple(tuple_from_child, &rid, exec_ctx_->GetTransaction(), strategy.get());
       assert(rid.GetPageId() != INVALID_PAGE_ID);
     }
   }
@@ -19,7 +19,9 @@ namespace bustub {
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
   : AbstractExecutor(exec_ctx),
     plan_(plan),
-    table_iterator(exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())->table_->Begin(exec_ctx_->GetTransaction())) {}  // NOLINT
+    strategy_(exec_ctx->IsBulkAccess() ? std::make_unique<BufferAccessStrategy>(exec_ctx->GetBufferPoolManager())
+                                       : nullptr),
+    table_iterator(exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())->table_.get(), exec_ctx_->GetTransaction(), strategy_.get()) {}  // NOLINT
 
 void SeqScanExecutor::Init() {}
 
@@ -36,21 +38,17 @@ bool SeqScanExecutor::Next(Tuple *tuple) {
   const std::vector<Column> &output_cols = output_schema->GetColumns();
   // 0.3. predicate
   const AbstractExpression *predicate = plan_->GetPredicate();
-  // 0.4. get table heap => tables
-  TableHeap *table_heap = table_metadata->table_.get();
 
   // 1. iterator all tuple
   //    original in table schema (not output tuple, not output schema)
   //      must get original tuple from table schema, since predicate can have no lint with output
-  Tuple original_tuple;
-  while (table_iterator != table_heap->End()) {
-    original_tuple = *table_iterator++;
-    if ((predicate != nullptr) ? predicate->Evaluate(&original_tuple, table_schema).GetAs<bool>() : true) {
+  while (table_iterator.Next(&original_tuple_)) {
+    if ((predicate != nullptr) ? predicate->Evaluate(&original_tuple_, table_schema).GetAs<bool>() : true) {
       // 1.1 original tuple qualified, build output tuple
       std::vector<Value> output_values;
       output_values.reserve(output_schema_col_count);
       for (size_t i = 0; i < output_schema_col_count; i++) {
-        output_values.emplace_back(output_cols[i].GetExpr()->Evaluate(&original_tuple, table_schema));
+        output_values.emplace_back(output_cols[i].GetExpr()->Evaluate(&original_tuple_, table_schema));
       }
       assert(output_values.size() == output_schema_col_count);
       *tuple = Tuple(output_values, output_schema);
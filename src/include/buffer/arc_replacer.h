@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace bustub {
+
+/**
+ * ArcReplacer implements the Adaptive Replacement Cache policy.
+ *
+ * Resident frames live in T1 (referenced once since they were loaded) or T2 (referenced again), both in LRU order.
+ * The page ids of pages recently evicted from T1 and T2 are remembered in the ghost lists B1 and B2. A miss on a
+ * page in B1 means T1 was too small and grows the target size p of T1; a miss on a page in B2 shrinks it. Victims are
+ * taken from the LRU end of T1 while it is larger than p, otherwise from T2. A scan only ever passes through T1, so
+ * the working set in T2 survives it.
+ *
+ * As in the LRU-K replacer, a reference within correlated_period ticks of the frame's previous reference is
+ * correlated with it (e.g. a scan fetching one page per tuple) and does not promote the frame from T1 to T2.
+ */
+class ArcReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ArcReplacer.
+   * @param num_pages the maximum number of pages the ArcReplacer will be required to store
+   * @param correlated_period references closer than this many ticks are correlated; 0 = no correlated references
+   */
+  ArcReplacer(size_t num_pages, uint64_t correlated_period);
+
+  /**
+   * Destroys the ArcReplacer.
+   */
+  ~ArcReplacer() override;
+
+  /**
+   * Remove the LRU evictable frame of T1 if T1 is larger than its target size, otherwise of T2.
+   * The page of the victim is remembered in the ghost list of its list once the frame is loaded with another page.
+   * @param[out] frame_id the victim frame
+   * @return true for frame victimized, otherwise false
+   */
+  bool Victim(frame_id_t *frame_id) override;
+
+  /**
+   * Make the frame non-evictable. A re-reference moves the frame to the MRU end of T2.
+   * @param frame_id the frame which was pinned
+   */
+  void Pin(frame_id_t frame_id) override;
+
+  /**
+   * Make the frame evictable.
+   * @param frame_id the frame whose pin count dropped to 0
+   */
+  void Unpin(frame_id_t frame_id) override;
+
+  /**
+   * Put a victim the buffer pool did not claim back into its list, its page is still resident. Unless it is referenced
+   * again, its next Unpin links it at the LRU end.
+   * @param frame_id the frame returned by Victim
+   */
+  void Reinstate(frame_id_t frame_id) override;
+
+  /**
+   * Drop the frame from T1 or T2 without remembering its page, the page was deleted.
+   * @param frame_id the frame of the deleted page
+   */
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * Place a newly loaded page: into T2 on a ghost hit, adapting the target size of T1, otherwise into T1. The page
+   * evicted from the frame becomes a ghost.
+   * @param frame_id the frame the page was loaded into
+   * @param page_id the loaded page
+   */
+  void Load(frame_id_t frame_id, page_id_t page_id) override;
+
+  /**
+   * Adapt the size of the cache, and with it the bound of the target size of T1 and of the ghost lists.
+   * @param num_frames the new number of frames
+   */
+  void SetNumFrames(size_t num_frames) override;
+
+  /** @return the number of evictable frames */
+  size_t Size() override;
+
+  /** @return the frame which would be victimized next, 0 if no frame is evictable */
+  frame_id_t NextVictimHint() override;
+
+  /**
+   * Order frames by recency within T2, then by recency within T1: pages referenced again are hotter than pages
+   * referenced once. Frames in neither list come last.
+   * @param[in,out] frame_ids the frames to order
+   */
+  void SortByHotness(std::vector<frame_id_t> *frame_ids) override;
+
+  /** @return the current target size of T1 */
+  size_t GetTargetT1Size() {
+    std::lock_guard<std::mutex> lock(latch_);
+    return p_;
+  }
+
+ private:
+  enum class ListType { NONE, T1, T2 };
+
+  struct FrameInfo {
+    /** The list the frame belongs to. Only evictable frames are linked into it, see Link. */
+    ListType list_ = ListType::NONE;
+    /** The list the frame was victimized from, while its page is resident until the frame is loaded again. */
+    ListType victim_of_ = ListType::NONE;
+    /** Position of the frame in its list, while it is evictable. */
+    std::list<frame_id_t>::iterator pos_;
+    /** The page held by the frame, INVALID_PAGE_ID if unknown. */
+    page_id_t page_id_ = INVALID_PAGE_ID;
+    /** Timestamp of the last reference. */
+    uint64_t last_ = 0;
+    /** True if the frame may be victimized, then it is linked into its list. */
+    bool evictable_ = false;
+    /** True if the frame was reinstated and is linked at the LRU end of its list, not at the MRU end, when unpinned. */
+    bool reinstated_ = false;
+    /** True if the frame was loaded and its first pin, the load itself, is still outstanding. */
+    bool loaded_ = false;
+  };
+
+  /** A list of page ids of evicted pages, MRU at the front, with an index for lookups. */
+  struct GhostList {
+    /** @return true if the page was found and removed */
+    bool Erase(page_id_t page_id);
+    void PushFront(page_id_t page_id);
+    void PopBack();
+    size_t Size() const { return pages_.size(); }
+
+    std::list<page_id_t> pages_;
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+  };
+
+  /**
+   * Find the frame Victim would remove.
+   * @param[out] frame_id the LRU frame of the list victims are taken from, or of the other list
+   * @return true if there is an evictable frame
+   */
+  bool FindVictim(frame_id_t *frame_id);
+  /** Move a non-evictable frame to another list, or to none. */
+  void SetList(frame_id_t frame_id, ListType list_type);
+  /** Make the frame evictable and link it into its list, at the MRU end unless it was reinstated. */
+  void Link(frame_id_t frame_id);
+  /** Make the frame non-evictable and unlink it from its list. */
+  void Unlink(frame_id_t frame_id);
+  /** Put a victim whose page is still resident back into the list it was victimized from. */
+  void Relink(frame_id_t frame_id);
+
+  /** Size of the cache c: the number of frames of the buffer pool. */
+  size_t capacity_;
+  const uint64_t correlated_period_;
+  /** Logical clock, advanced on every reference. */
+  uint64_t current_timestamp_ = 0;
+  /** Target size of T1. */
+  size_t p_ = 0;
+  /** Number of evictable frames. */
+  size_t size_ = 0;
+  std::vector<FrameInfo> frames_;
+  /** Evictable frames, MRU at the front. Pinned frames are unlinked, so the LRU end can always be victimized. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Number of resident frames in T1 and T2, pinned or not. */
+  size_t t1_size_ = 0;
+  size_t t2_size_ = 0;
+  /** Ghost page ids of evicted frames. */
+  GhostList b1_;
+  GhostList b2_;
+  /** Latch */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy is the "bulk access" strategy of a single scan or bulk insert.
+ *
+ * Pages the scan has to load are put into a small ring of frames which the scan recycles itself: once the ring is
+ * full, the next miss reuses the frame of the oldest ring page instead of evicting a page of the shared pool, so a
+ * full-table scan cannot flush the working set of other sessions. Pages which are already resident are used as they
+ * are and do not enter the ring. A ring frame which was evicted, or which is pinned when it is due, is replaced by a
+ * frame of the shared pool.
+ *
+ * A strategy belongs to a single scan and is NOT THREAD SAFE.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+ public:
+  /**
+   * Create a new BufferAccessStrategy.
+   * @param bpm the buffer pool manager the strategy is used with
+   * @param ring_size the number of frames of the ring, capped at 1/8 of the pool
+   */
+  explicit BufferAccessStrategy(BufferPoolManager *bpm, size_t ring_size = BULK_ACCESS_RING_SIZE);
+
+  ~BufferAccessStrategy() = default;
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /** @return the number of frames of the ring */
+  size_t GetRingSize() const { return ring_size_; }
+
+ private:
+  /** A frame the scan loaded a page into. owner_ is the shard holding the frame in a partitioned pool. */
+  struct Slot {
+    BufferPoolManager *owner_;
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+  };
+
+  /**
+   * Get the ring frame due for reuse.
+   * @param owner the buffer pool (shard) looking for a frame
+   * @param[out] frame_id the frame due for reuse
+   * @param[out] page_id the page the scan loaded into that frame
+   * @return true if the ring is full and its next frame belongs to the owner
+   */
+  bool NextSlot(BufferPoolManager *owner, frame_id_t *frame_id, page_id_t *page_id) const;
+
+  /**
+   * Record a page the scan loaded, replacing the ring frame due for reuse once the ring is full.
+   * @param owner the buffer pool (shard) holding the frame
+   * @param frame_id the frame the page was loaded into
+   * @param page_id the loaded page
+   */
+  void Record(BufferPoolManager *owner, frame_id_t frame_id, page_id_t page_id);
+
+  const size_t ring_size_;
+  std::vector<Slot> ring_;
+  /** Position of the next frame to reuse. */
+  size_t next_ = 0;
+};
+
+}  // namespace bustub
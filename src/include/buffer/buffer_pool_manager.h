@@ -12,10 +12,24 @@
 
 #pragma once
 
-#include <list>  // NOLINT
+#include <atomic>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <list>                // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <thread>              // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/clock_replacer.h"
+#include "buffer/concurrent_page_table.h"
+#include "buffer/lock_free_clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/page_trace_recorder.h"
+#include "buffer/swizzled_page_ref.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -28,6 +42,8 @@ namespace bustub {
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
+  /** Replacement policy of the buffer pool. */
+  enum class ReplacerType { CLOCK, LRU_K, ARC, LOCK_FREE_CLOCK };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
   /**
@@ -35,8 +51,14 @@ class BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param num_shards number of partitions the pool is split into; 1 = a single latch for the whole pool
+   * @param replacer_type the replacement policy, tuned by LRUK_REPLACER_K and REPLACER_CORRELATED_PERIOD
+   * @param max_pool_size the size Resize may grow the pool to, 0 = pool_size. Address space and frame book-keeping
+   * are reserved for it up front, the page data of the reserved frames costs no memory until they are used.
    */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                    size_t num_shards = 1, ReplacerType replacer_type = ReplacerType::LOCK_FREE_CLOCK,
+                    size_t max_pool_size = 0);
 
   /**
    * Destroys an existing BufferPoolManager.
@@ -90,45 +112,269 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Resize the buffer pool while it keeps serving requests. Growing hands reserved frames to the free list. Shrinking
+   * stops handing out the frames beyond the new size, then drains them: unpinned pages are written back if dirty and
+   * evicted, pinned pages are waited for, and the memory of the drained frames is given back to the system.
+   * A partitioned pool resizes every shard.
+   * @param new_pool_size the new number of frames, at most the max_pool_size of the constructor
+   * @return false if new_pool_size is larger than the reserved frames or smaller than the number of shards
+   */
+  bool Resize(size_t new_pool_size);
+
+  /**
+   * Fetch several pages at once and pin each of them, e.g. the unrelated pages of a hash join probe. Hits are pinned
+   * right away, the misses of all pages are read with one batched DiskManager::ReadPages call instead of one blocking
+   * read per page. A page id listed twice is pinned twice.
+   * The fetch is all-or-nothing: if a page cannot be fetched because every frame is pinned, the pages fetched so far
+   * are unpinned again and the call fails. Batches larger than the free and evictable frames therefore fail.
+   * @param page_ids ids of the pages to be fetched
+   * @param[out] pages pages[i] is the fetched page of page_ids[i], all nullptr if the fetch failed
+   * @return true if every page was fetched and pinned, false if none is pinned
+   */
+  bool FetchPages(const std::vector<page_id_t> &page_ids, Page **pages);
+
+  /**
+   * Fetch and pin the page of a swizzled reference, see SwizzledPageRef. A swizzled reference pins its frame directly,
+   * without a page table lookup. Otherwise the page is fetched like FetchPage and the reference is swizzled, unless
+   * another reference already swizzles the frame. The page is unpinned with UnpinSwizzled or UnpinPage.
+   * @param ref the reference to the page
+   * @return the requested page, nullptr if every frame is pinned
+   */
+  Page *FetchSwizzled(SwizzledPageRef *ref);
+
+  /**
+   * Unpin a page without a page table lookup, e.g. a page fetched by FetchSwizzled: the caller's pin keeps the page in
+   * its frame.
+   * @param page the pinned page
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page was not pinned, true otherwise
+   */
+  bool UnpinSwizzled(Page *page, bool is_dirty);
+
+  /**
+   * Unswizzle a reference before its owner destroys it. Must not run concurrently with a FetchSwizzled of the
+   * same reference.
+   * @param ref the reference to unswizzle
+   */
+  void Unswizzle(SwizzledPageRef *ref);
+
+  /**
+   * Fetch a page through a bulk access strategy: a miss recycles a frame of the strategy's ring instead of evicting
+   * a page of the shared pool.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the scan, nullptr = normal access
+   * @return the requested page
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPageImpl(page_id, strategy);
+  }
+
+  /**
+   * Create a new page through a bulk access strategy, see FetchPageWithStrategy.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of the bulk insert, nullptr = normal access
+   * @param hint a page the new page should be placed close to on disk, see DiskManager::AllocatePage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint = INVALID_PAGE_ID) {
+    return NewPageImpl(page_id, strategy, hint);
+  }
+
+  /**
+   * Asynchronously load a page into a free or evictable frame, without pinning it for the caller. A prefetch is only a
+   * hint: it is dropped if the page is resident, was never allocated, every frame is pinned or the queue is full.
+   * The load does not count as a reference for the replacer, the caller's fetch does.
+   * @param page_id id of page to be prefetched
+   */
+  void Prefetch(page_id_t page_id);
+
+  /**
+   * Asynchronously load the pages [first_page_id, first_page_id + num_pages), see Prefetch.
+   * @param first_page_id id of the first page to be prefetched
+   * @param num_pages number of pages to be prefetched
+   */
+  void PrefetchRange(page_id_t first_page_id, size_t num_pages);
+
+  /** @return number of pages loaded by prefetching */
+  size_t GetNumPrefetches();
+
+  /**
+   * Start the background page cleaner. Every page_cleaner_interval, or whenever an eviction had to write back a dirty
+   * victim, it walks the frames from the replacer's next victim onwards and writes back dirty unpinned frames until
+   * target_clean_ratio of the pool is clean or free. Pages whose log records are not persistent yet are skipped.
+   * A partitioned pool runs one cleaner per shard.
+   * @param target_clean_ratio fraction of the frames ahead of eviction that should be clean, in (0, 1]
+   */
+  void RunPageCleaner(double target_clean_ratio = 0.25);
+
+  /**
+   * Stop and join the page cleaner. Called by the destructor if the cleaner is still running.
+   */
+  void StopPageCleaner();
+
+  /**
+   * Keep the buffer pool warm across restarts. If file_name holds a snapshot, a background thread loads its hottest
+   * pages into the free frames, sorted by page id and in batches, so that runs of pages are read with few large reads.
+   * On destruction, the resident pages are saved to file_name ordered from the hottest to the coldest according to
+   * the replacer, see SaveWarmupSnapshot.
+   * @param file_name the snapshot file
+   * @return true if a snapshot was found and is being loaded
+   */
+  bool EnableWarmupSnapshot(const std::string &file_name);
+
+  /**
+   * Write the ids of the resident pages to a snapshot file, hottest first. The file is a plain array of page ids in
+   * native byte order, and replaced atomically.
+   * @param file_name the snapshot file
+   * @return false if the file could not be written
+   */
+  bool SaveWarmupSnapshot(const std::string &file_name);
+
+  /** Wait until the warm-up started by EnableWarmupSnapshot has loaded its pages. */
+  void WaitForWarmup();
+
+  /** @return number of pages loaded by the warm-up */
+  size_t GetNumWarmupPages() { return num_warmup_pages_; }
+
+  /** @return number of pages evicted from the buffer pool */
+  size_t GetNumEvictions();
+
+  /** @return number of evictions which had to write back a dirty victim in the foreground */
+  size_t GetNumForegroundWrites();
+
+  /** @return number of dirty victims written back asynchronously from the write-back staging buffer */
+  size_t GetNumStagedWrites();
+
+  /** @return number of pages written back by the page cleaner */
+  size_t GetNumCleanerWrites();
+
+  /**
+   * Start recording every FetchPage and NewPage into a trace file, see PageTraceRecorder. A running trace is stopped.
+   * The trace can be replayed offline with PageTraceSimulator to pick the pool size and the replacement policy.
+   * @param file_name the trace file
+   * @return false if the file could not be opened
+   */
+  bool StartPageTrace(const std::string &file_name) { return trace_recorder_.Start(file_name); }
+
+  /** Stop recording page references and flush the trace file. */
+  void StopPageTrace() { trace_recorder_.Stop(); }
+
+  /** @return a new replacer of the given policy for pool_size frames */
+  static Replacer *MakeReplacer(ReplacerType replacer_type, size_t pool_size);
+
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /** @return the size the buffer pool can be resized to at most */
+  size_t GetMaxPoolSize() { return max_pool_size_; }
+
+  /** @return number of shards of the buffer pool, 1 if the pool is not partitioned */
+  size_t GetNumShards() { return shards_.empty() ? 1 : shards_.size(); }
+
   /** @return the size of page table (Added by Jigao for test case) */
   inline size_t GetPageTableSize() {
+    if (!shards_.empty()) {
+      size_t size = 0;
+      for (auto shard : shards_) {
+        size += shard->GetPageTableSize();
+      }
+      return size;
+    }
     std::shared_lock<std::shared_mutex> lock(global_latch_);
-    return page_table_.size();
+    return page_table_.Size();
   }
 
   /** @return true for the page loaded in buffer pool, otherwise false (Added by Jigao for test case) */
   inline bool FindInBuffer(page_id_t page_id) {
-    std::shared_lock<std::shared_mutex> lock(global_latch_);
-    return page_table_.find(page_id) != page_table_.end();
+    if (!shards_.empty()) {
+      return ShardOf(page_id)->FindInBuffer(page_id);
+    }
+    frame_id_t frame_id;
+    return page_table_.Find(page_id, &frame_id);
   }
 
   /** @return the pin count of the page id (Added by Jigao for test case) */
   inline int GetPagePinCount(page_id_t page_id) {
+    if (!shards_.empty()) {
+      return ShardOf(page_id)->GetPagePinCount(page_id);
+    }
     std::shared_lock<std::shared_mutex> lock(global_latch_);
-    const auto& got = page_table_.find(page_id);
-    assert(got != page_table_.end());
-    return (pages_ + got->second)->GetPinCount();
+    frame_id_t frame_id;
+    [[maybe_unused]] const bool found = page_table_.Find(page_id, &frame_id);
+    assert(found);
+    return (pages_ + frame_id)->GetPinCount();
   }
 
   /** @return the size of replacer (Added by Jigao for test case) */
   inline size_t GetReplacerSize() {
+    if (!shards_.empty()) {
+      size_t size = 0;
+      for (auto shard : shards_) {
+        size += shard->GetReplacerSize();
+      }
+      return size;
+    }
     std::shared_lock<std::shared_mutex> lock(global_latch_);
     return replacer_->Size();
   }
 
   /** @return the size of free list (Added by Jigao for test case) */
   inline size_t GetFreeListSize() {
+    if (!shards_.empty()) {
+      size_t size = 0;
+      for (auto shard : shards_) {
+        size += shard->GetFreeListSize();
+      }
+      return size;
+    }
     std::shared_lock<std::shared_mutex> lock(global_latch_);
     return free_list_.size();
   }
 
  private:
+  /**
+   * Creates one shard of a partitioned BufferPoolManager.
+   * The shard manages the frames [pages, pages + max_pool_size) but does not own them.
+   * @param pool_size the number of frames of this shard
+   * @param max_pool_size the number of frames reserved for this shard
+   * @param pages the first frame of this shard
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager
+   * @param replacer_type the replacement policy
+   */
+  BufferPoolManager(size_t pool_size, size_t max_pool_size, Page *pages, DiskManager *disk_manager,
+                    LogManager *log_manager, ReplacerType replacer_type);
+
+  /** Create the replacer and put the first pool_size_ frames into the free list. */
+  void InitFrames(ReplacerType replacer_type);
+
+  /** @return the number of frames of a shard when pool_size frames are split over num_shards shards */
+  static size_t ShardSize(size_t pool_size, size_t shard, size_t num_shards) {
+    return pool_size / num_shards + (shard < pool_size % num_shards ? 1 : 0);
+  }
+
+  /**
+   * Evict the page of a frame beyond the pool size, which a shrinking Resize takes away. Waits while the page is
+   * pinned. The frame is left claimed and never handed out again, until the pool grows.
+   * @param frame_id the frame to drain
+   */
+  void DrainFrame(frame_id_t frame_id);
+
+  /**
+   * Allocate the page data of pool_size frames as one PAGE_SIZE-aligned, zeroed region, suitable for direct I/O.
+   * If buffer_pool_huge_pages is set, the region is backed by transparent huge pages where the kernel supports it.
+   * @param pool_size the number of frames
+   * @return the region
+   */
+  static char *AllocateFrameData(size_t pool_size);
+
+  /** Free a region returned by AllocateFrameData. */
+  static void FreeFrameData(char *frame_data, size_t pool_size);
+
   /**
    * Grading function. Do not modify!
    * Invokes the callback function if it is not null.
@@ -145,9 +391,13 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the caller, nullptr = normal access
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /** FetchPageImpl without recording the fetch in the page trace, for callers which recorded it already. */
+  Page *FetchPageUntraced(page_id_t page_id, BufferAccessStrategy *strategy);
 
   /**
    * Unpin the target page from the buffer pool.
@@ -167,9 +417,11 @@ class BufferPoolManager {
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param strategy the access strategy of the caller, nullptr = normal access
+   * @param hint a page the new page should be placed close to on disk, INVALID_PAGE_ID = none
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy = nullptr, page_id_t hint = INVALID_PAGE_ID);
 
   /**
    * Deletes a page from the buffer pool.
@@ -179,51 +431,362 @@ class BufferPoolManager {
   bool DeletePageImpl(page_id_t page_id);
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk. The pages which are dirty when the flush starts are written in
+   * page id order, runs of consecutive pages as single writes, without holding the latch. The file is synced once
+   * at the end.
    */
   void FlushAllPagesImpl();
 
   /**
-   * Evict a page from free list or replacer. Always pick from the free list first.
+   * Creates a new page with an already allocated page id in this pool or shard.
+   * Used by NewPageImpl, which allocates the page id first: outside of the latch, and to know which shard owns it.
+   * @param page_id id of the page to be created
+   * @param strategy the access strategy of the caller, nullptr = normal access
+   * @return nullptr if all frames of this shard are pinned, otherwise pointer to new page
+   */
+  Page *NewPageInShard(page_id_t page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Load pages requested by Prefetch with one batched read, and unpin them right away. Resident pages are skipped.
+   * Called by the prefetch thread.
+   * @param page_ids ids of the pages to be loaded
+   */
+  void LoadPrefetched(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * One round of the page cleaner: write back dirty unpinned frames in eviction order, starting at the replacer's
+   * next victim, until target_clean_ratio of the frames are clean or free.
+   * @param target_clean_ratio fraction of the frames that should be clean
+   */
+  void CleanFrames(double target_clean_ratio);
+
+  /**
+   * Write back a dirty unpinned frame under its read latch, unless the WAL forbids it.
+   * An eviction claiming the frame meanwhile waits for the write latch and then finds the victim clean.
+   * @param page the frame to write back
+   * @return true if the frame is clean afterwards
+   */
+  bool CleanFrame(Page *page);
+
+  /**
+   * Unswizzle the reference to a frame, if any, before the frame is given to another page or freed.
+   * Should be called with global_latch_ locked exclusively and the frame claimed.
+   * @param frame_id the claimed frame
+   */
+  void UnswizzleFrame(frame_id_t frame_id);
+
+  /** @return the shard which owns the page id. Only valid for a partitioned BufferPoolManager. */
+  inline BufferPoolManager *ShardOf(page_id_t page_id) {
+    // Page ids are handed out densely by the disk manager, so modulo spreads them evenly over the shards.
+    return shards_[static_cast<size_t>(page_id) % shards_.size()];
+  }
+
+  /** A frame claimed for a page by FetchPages, whose page still has to be read. */
+  struct PendingRead {
+    /** The pool or shard owning the frame. */
+    BufferPoolManager *shard_;
+    /** The claimed frame, write latched and pinned. */
+    Page *page_;
+    /** The page evicted from the frame, INVALID_PAGE_ID if the frame was free. */
+    page_id_t victim_page_id_;
+    /** True if the evicted page has to be written back first. */
+    bool victim_dirty_;
+  };
+
+  /** A dirty victim on its way to disk, see StageVictim. */
+  struct StagedWrite {
+    /** The victim's data: a staging slot, or the frame of the victim while the evicting thread writes it back. */
+    char *data_;
+    /** LSN of the victim, the log has to be persistent up to it before the write. */
+    lsn_t lsn_;
+    /** True once the write has started, the copy can no longer be taken back. */
+    bool in_flight_;
+  };
+
+  /** A page which was dirty when FlushAllPages started. */
+  struct DirtyPage {
+    /** The pool or shard owning the frame. */
+    BufferPoolManager *shard_;
+    Page *page_;
+    /** The page held by the frame at the snapshot. */
+    page_id_t page_id_;
+  };
+
+  /**
+   * Snapshot the dirty pages of this pool or shard for FlushAllPages, then wait for the pending write-backs of the
+   * pages evicted before.
+   * @param[out] dirty_pages the dirty pages are appended to it
+   */
+  void CollectDirtyPages(std::vector<DirtyPage> *dirty_pages);
+
+  /**
+   * Write back the snapshot of FlushAllPages, in batches of FLUSH_BATCH_PAGES read latched pages.
+   * @param dirty_pages the dirty pages, sorted by page id
+   */
+  void WriteDirtyPages(const std::vector<DirtyPage> &dirty_pages);
+
+  /**
+   * Called with the page read latched: check that the frame still holds the dirty page of the snapshot, and mark it
+   * clean before it is written. Otherwise releases the latch.
+   * @param dirty_page the page of the snapshot
+   * @return true if the page has to be written, and is still read latched
+   */
+  bool StartFlush(const DirtyPage &dirty_page);
+
+  /**
+   * FetchPages without recording the references in the page trace. Unlike FetchPages, a failed fetch leaves the pages
+   * which could be fetched pinned, pages[i] is nullptr for the others.
+   * @param prefetch true if the pages are prefetched: resident pages are skipped, and the loads are not references
+   * for the replacer, see Evict. pages[i] is only set for the pages loaded by this call.
+   */
+  bool FetchPagesImpl(const std::vector<page_id_t> &page_ids, Page **pages, bool prefetch = false);
+
+  /**
+   * Collect the pages resident in this pool or shard, hottest first according to the replacer.
+   * @param[out] page_ids the resident pages
+   */
+  void CollectHotPages(std::vector<page_id_t> *page_ids);
+
+  /**
+   * Pin the resident pages among page_ids[indices] and claim frames for the others, see FetchPages.
+   * @param page_ids ids of the pages to be fetched
+   * @param indices the indices into page_ids owned by this pool or shard
+   * @param[out] pages pages[i] is the pinned or claimed frame of page_ids[i], nullptr if every frame was pinned
+   * @param[out] reads the claimed frames whose pages have to be read
+   * @param prefetch true if the pages are prefetched, see FetchPagesImpl. A prefetch claims at most half of the free
+   * and evictable frames.
+   */
+  void ClaimPages(const std::vector<page_id_t> &page_ids, const std::vector<size_t> &indices, Page **pages,
+                  std::vector<PendingRead> *reads, bool prefetch);
+
+  /**
+   * Evict a page from the strategy's ring, free list or replacer. A full ring is recycled first, then the free list
+   * is used before the replacer.
    * Update select page metadata to contain page_id and add it to the page table.
    * NOT THREAD SAFE, should be called with u_lock locked
-   * Precondition: can find one evict page => !free_list_.empty() || replacer_->Size() != 0
    * @param new_page if is called by NewPageImpl
    * @param u_lock Precondition: locked
-   * @return the frame where page evicted
+   * @param strategy the access strategy of the caller, nullptr = normal access
+   * @param prefetch true if the page is prefetched: the replacer is told about the load, but not about a reference
+   * @return the frame where page evicted, nullptr if every frame turned out to be pinned
    */
-  Page *Evict(page_id_t page_id, bool new_page, std::unique_lock<std::shared_mutex>* u_lock);
+  Page *Evict(page_id_t page_id, bool new_page, std::unique_lock<std::shared_mutex> *u_lock,
+              BufferAccessStrategy *strategy, bool prefetch = false);
 
   /**
-   * check if all pages are pinned
-   * This function is NOT THREAD SAFE, should be called with protection of mutex
+   * The part of Evict under the latch: claim a frame for page_id and publish P in the page table, without any I/O.
+   * The frame is returned write latched and pinned; the caller writes back the victim, loads P and unlatches it.
+   * NOT THREAD SAFE, should be called with the latch held exclusively
+   * @param page_id id of the page to be loaded
+   * @param new_page if is called by NewPageImpl
+   * @param strategy the access strategy of the caller, nullptr = normal access
+   * @param prefetch true if the page is prefetched, see Evict
+   * @param[out] victim_page_id the page evicted from the frame, INVALID_PAGE_ID if the frame was free
+   * @param[out] victim_dirty true if the victim has to be written back
+   * @param u_lock the exclusive latch, released while a new page waits for a stale copy, see TakeStaleFrame. May be
+   * nullptr if new_page is false
+   * @return the claimed frame, nullptr if every frame turned out to be pinned
    */
-  bool IsAllPinned() {
-    for (size_t i = 0; i < pool_size_; i++) {
-      Page *const page = pages_ + i;
-      if (page->page_id_ != INVALID_PAGE_ID && page->pin_count_ == 0) {
-        return false;
-      }
-    }
-    return true;
-  }
+  Page *ClaimFrame(page_id_t page_id, bool new_page, BufferAccessStrategy *strategy, bool prefetch,
+                   page_id_t *victim_page_id, bool *victim_dirty, std::unique_lock<std::shared_mutex> *u_lock);
+
+  /**
+   * Write back the dirty victim of a claimed frame, flushing the log first if the WAL requires it.
+   * @param page the claimed frame, still holding the victim's data
+   * @param victim_page_id the page evicted from the frame
+   * @param new_page if the frame was claimed by NewPageImpl
+   */
+  void WriteBackVictim(Page *page, page_id_t victim_page_id, bool new_page);
 
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
+  /**
+   * Hand over the write-back of a dirty victim. If a staging slot is free, the victim is copied into it and written
+   * back by the write-back thread, and the frame can be loaded right away. Otherwise the caller writes it back from
+   * the frame with WriteBackVictim. Either way, misses of the victim load it from memory until it is on disk, see
+   * ReadStaged. A write-back of the victim still queued from an earlier eviction is replaced by the new data, one
+   * being written is waited for.
+   * Should be called with global_latch_ locked exclusively and the frame claimed and write latched.
+   * @param page the claimed frame, still holding the victim's data
+   * @param victim_page_id the page evicted from the frame
+   * @return true if the victim was staged, false if the caller has to write it back
+   */
+  bool StageVictim(Page *page, page_id_t victim_page_id);
+
+  /**
+   * Load a page from its pending write-back, if any. The page is clean either way: a staged copy whose write has not
+   * started is copied and stays queued, a later write of the page replaces it or drops it, see StageVictim and
+   * DropStagedWrite. A copy being written is copied, then waited for, so that no later write of the page can
+   * overtake it.
+   * @param page the claimed frame, page_id_ is the page to be loaded
+   * @return true if the page was loaded, false if it has to be read from disk
+   */
+  bool ReadStaged(Page *page);
+
+  /**
+   * Drop the pending write-back of a page which is being deleted or written anew, waiting for a write which has
+   * already started.
+   * @param page_id id of the page
+   */
+  void DropStagedWrite(page_id_t page_id);
+
+  /**
+   * Wait until the pending write-backs of this pool or shard are on disk.
+   * @param page_id the page to wait for, INVALID_PAGE_ID = all pages with a write-back pending at the time of the call
+   */
+  void WaitForStagedWrites(page_id_t page_id = INVALID_PAGE_ID);
+
+  /** Write back staged victims in eviction order until stopped. Run by the write-back thread. */
+  void WriteBackStaged();
+
+  /**
+   * Claim the frame of a page that is being created although it is in the page table: a prefetch racing with the
+   * allocation of the page, or a fetch of its id before it was deleted and reused, loaded it, so its content is
+   * garbage. If the frame is pinned, waits until it is unpinned, the page id must not be mapped to a second frame.
+   * The latch is released while waiting. The frame is write latched.
+   * Should be called with the latch held exclusively.
+   * @param page_id id of the page being created
+   * @param[out] frame_id the claimed frame
+   * @param u_lock the exclusive latch
+   * @return true if the page was in the page table and its frame was claimed
+   */
+  bool TakeStaleFrame(page_id_t page_id, frame_id_t *frame_id, std::unique_lock<std::shared_mutex> *u_lock);
+
+  /**
+   * Claim the ring frame of the strategy which is due for reuse, write latch it and take it out of the replacer.
+   * Should be called with the latch held exclusively.
+   * @param strategy the access strategy
+   * @param[out] frame_id the claimed frame
+   * @return false if the ring is not full, or its frame was evicted meanwhile, is pinned or is latched, e.g. by
+   * FlushAllPages
+   */
+  bool TakeRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id);
+
+  /**
+   * Pin a frame found in the page table, removing it from the replacer on its first pin.
+   * Should be called with global_latch_ locked exclusively, so that the frame cannot be claimed.
+   * @param frame_id the frame holding the requested page
+   * @return the pinned page
+   */
+  Page *PinFrame(frame_id_t frame_id);
+
+  /**
+   * Lock-free pin of a frame found in the page table without holding global_latch_.
+   * Fails if the frame is claimed, or if it was given to another page after the lookup.
+   * @param frame_id the frame the page table returned
+   * @param page_id the page that was looked up
+   * @return the pinned page, nullptr if the caller has to retry under global_latch_
+   */
+  Page *TryPinFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Drop one pin of a frame, handing it to the replacer when the last pin is gone. Thread safe.
+   * @param frame_id the frame to unpin
+   * @return false if the frame was not pinned, true otherwise
+   */
+  bool UnpinFrame(frame_id_t frame_id);
+
+  /**
+   * Take a victim from the replacer, claim it and write latch it, skipping frames which got pinned again by a
+   * concurrent hit. Frames latched by someone else, e.g. by FlushAllPages writing them, are skipped as well: waiting
+   * for them would stall every miss behind the exclusive latch. Only if every victim is latched, the first one is
+   * waited for.
+   * NOT THREAD SAFE, should be called with global_latch_ locked exclusively.
+   * @param[out] frame_id the victim frame
+   * @return true if an unpinned victim was found, false otherwise
+   */
+  bool PickVictim(frame_id_t *frame_id);
+
+  /** Number of pages in the buffer pool. Changed by Resize under the exclusive latch. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames reserved for the buffer pool, pool_size_ may grow up to it. */
+  const size_t max_pool_size_;
+  /** Serializes Resize calls. */
+  std::mutex resize_latch_;
+  /** Array of buffer pool pages: the book-keeping of the frames. */
   Page *pages_;
+  /** Page data of all frames, PAGE_SIZE-aligned. Only set if this object owns the frames. */
+  char *frame_data_ = nullptr;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Pin count of a frame which is free or claimed by an eviction or deletion. Lock-free hits never pin it. */
+  static constexpr int FRAME_CLAIMED = -1;
+
+  /** Page table for keeping track of buffer pool pages. Lookups are lock-free, updates need global_latch_. */
+  ConcurrentPageTable page_table_;
+  /** swizzled_refs_[i] is the reference swizzling frame i, nullptr if there is none. Set by FetchSwizzled while
+   *  the frame is pinned, cleared once the frame is claimed. */
+  std::vector<std::atomic<SwizzledPageRef *>> swizzled_refs_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
   /** This latch protects buffer manager's shared data structures:
-   *  page table, replacer, pages_(the buffer pool), free list */
+   *  page table updates, replacer victims, pages_(the buffer pool), free list.
+   *  Hits and unpins do not take it: they look up the page table lock-free and only touch the atomic pin count and
+   *  dirty flag of a frame. Misses, evictions and deletions hold it exclusively and claim a frame before reusing it. */
   std::shared_mutex global_latch_;
+  /** Shards of a partitioned buffer pool. Empty if the pool is not partitioned, otherwise all requests are routed
+   *  to the shard owning the page id and page table, replacer, free list and latch of this object stay unused. */
+  std::vector<BufferPoolManager *> shards_;
+  /** True if pages_ and frame_data_ were allocated by this object, false for a shard pointing into its parent's
+   *  frames. */
+  bool owns_pages_ = true;
+
+  /** Background page cleaner, nullptr if it is not running. */
+  std::thread *page_cleaner_thread_ = nullptr;
+  /** True while the page cleaner should keep running. */
+  std::atomic<bool> enable_page_cleaner_{false};
+  /** Protects the wait of the page cleaner. */
+  std::mutex page_cleaner_latch_;
+  /** Wakes the page cleaner up early, on stop or when an eviction had to write in the foreground. */
+  std::condition_variable page_cleaner_cv_;
+  /** Counters of evictions and of who wrote back the dirty pages. */
+  std::atomic<size_t> num_evictions_{0};
+  std::atomic<size_t> num_foreground_writes_{0};
+  std::atomic<size_t> num_cleaner_writes_{0};
+  std::atomic<size_t> num_staged_writes_{0};
+
+  /** Page data of the write-back staging slots, PAGE_SIZE-aligned. nullptr if staging is disabled, or for the parent
+   *  of a partitioned pool: every shard stages its own victims. */
+  char *staging_data_ = nullptr;
+  size_t num_staging_slots_ = 0;
+  /** The write-back staging state below is protected by staging_latch_. */
+  std::mutex staging_latch_;
+  /** Wakes the write-back thread up, and the threads waiting for a write-back to finish. */
+  std::condition_variable staging_cv_;
+  /** Dirty victims which are not on disk yet, by page id: staged ones and ones written back in the foreground. */
+  std::unordered_map<page_id_t, StagedWrite> staged_writes_;
+  /** Staged victims in eviction order. A victim taken back by a miss stays queued and is skipped. */
+  std::deque<page_id_t> staging_queue_;
+  std::vector<char *> free_staging_slots_;
+  /** Write-back thread, started by the first staged victim. */
+  std::thread *write_back_thread_ = nullptr;
+  std::once_flag write_back_thread_started_;
+  bool stop_write_back_ = false;
+
+  /** Prefetch thread, started by the first Prefetch. A partitioned pool runs one for all shards. */
+  std::thread *prefetch_thread_ = nullptr;
+  std::once_flag prefetch_thread_started_;
+  /** Pages waiting to be prefetched, protected by prefetch_latch_. */
+  std::deque<page_id_t> prefetch_queue_;
+  bool stop_prefetch_ = false;
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  std::atomic<size_t> num_prefetches_{0};
+
+  /** Maximum number of pages FlushAllPages writes with one batch, they stay read latched until it is written. */
+  static constexpr size_t FLUSH_BATCH_PAGES = 256;
+  /** Maximum number of pages the warm-up loads with one batched read. */
+  static constexpr size_t WARMUP_BATCH_PAGES = 64;
+  /** Snapshot file saved on destruction, empty if the warm-up snapshot is not enabled. */
+  std::string warmup_file_;
+  /** Thread loading the pages of a snapshot, nullptr if no warm-up is running. */
+  std::thread *warmup_thread_ = nullptr;
+  std::atomic<bool> stop_warmup_{false};
+  std::atomic<size_t> num_warmup_pages_{0};
+
+  /** Records page references while a trace is running. Only used by the top-level pool, not by its shards. */
+  PageTraceRecorder trace_recorder_;
 };
 }  // namespace bustub
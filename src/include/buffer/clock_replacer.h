@@ -65,6 +65,9 @@ class ClockReplacer : public Replacer {
   /** @return the number of frames that are currently in the ClockReplacer. */
   size_t Size() override;
 
+  /** @return the clock hand, the victim search starts there */
+  frame_id_t NextVictimHint() override { return static_cast<frame_id_t>(GetClockHand()); }
+
   /** @return get the position of clock hand */
   size_t GetClockHand() {
     std::shared_lock<std::shared_mutex> shared_lock(latch_);
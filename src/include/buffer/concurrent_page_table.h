@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.h
+//
+// Identification: src/include/buffer/concurrent_page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>  // NOLINT
+#include <cstdint>
+
+#include "common/config.h"
+#include "common/epoch_manager.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ConcurrentPageTable maps page ids to frame ids for the buffer pool manager.
+ *
+ * It is a fixed-capacity open-addressing hash table with linear probing, sized from the number of frames.
+ * Every slot is a single 64-bit word holding page id and frame id, so lookups are lock-free and never see a torn
+ * entry. Erased slots become tombstones; once live entries and tombstones fill 3/4 of the slots, the writer
+ * rebuilds the slot array and frees the old one through epoch-based reclamation.
+ *
+ * Find may be called concurrently from any thread. Insert and Erase must be serialized by the caller.
+ */
+class ConcurrentPageTable {
+ public:
+  /**
+   * Create a new ConcurrentPageTable.
+   * @param num_frames the maximum number of entries the table will be required to store
+   */
+  explicit ConcurrentPageTable(size_t num_frames);
+
+  ~ConcurrentPageTable();
+
+  DISALLOW_COPY_AND_MOVE(ConcurrentPageTable);
+
+  /**
+   * Lock-free lookup of a page.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page was found, false otherwise
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id);
+
+  /**
+   * Insert a mapping, or overwrite the mapping if the page is already present.
+   * NOT THREAD SAFE against other writers.
+   * @param page_id the page
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Erase a mapping.
+   * NOT THREAD SAFE against other writers.
+   * @param page_id the page
+   * @return true if the page was found and erased, false otherwise
+   */
+  bool Erase(page_id_t page_id);
+
+  /** @return the number of mappings in the table */
+  size_t Size() const { return size_.load(); }
+
+ private:
+  using slot_t = uint64_t;
+  /** A slot that has never been used. Probing stops here. */
+  static constexpr slot_t EMPTY = ~static_cast<slot_t>(0);
+  /** A slot whose entry was erased. Probing continues past it, Insert may reuse it. */
+  static constexpr slot_t TOMBSTONE = ~static_cast<slot_t>(0) << 32;
+
+  /** An array of slots, replaced as a whole when the table is rebuilt. */
+  struct SlotArray {
+    explicit SlotArray(size_t capacity);
+    ~SlotArray();
+    const size_t mask_;
+    std::atomic<slot_t> *const slots_;
+  };
+
+  static inline slot_t MakeSlot(page_id_t page_id, frame_id_t frame_id) {
+    return static_cast<slot_t>(static_cast<uint32_t>(page_id)) << 32 | static_cast<uint32_t>(frame_id);
+  }
+  static inline page_id_t PageOf(slot_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static inline frame_id_t FrameOf(slot_t slot) { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+  /** Page ids are dense, so spread them with a Fibonacci hash before masking. */
+  static inline size_t HashOf(page_id_t page_id) {
+    return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> 32);
+  }
+
+  /** Rebuild the slot array without tombstones and reclaim the old one once no reader can reference it. */
+  void Rebuild();
+
+  /** Number of slots. */
+  const size_t capacity_;
+  /** Current slot array. */
+  std::atomic<SlotArray *> slots_;
+  /** Number of live entries. */
+  std::atomic<size_t> size_{0};
+  /** Number of live entries and tombstones. Only accessed by the writer. */
+  size_t used_ = 0;
+  /** Protects readers of a slot array replaced by Rebuild. */
+  EpochManager epoch_manager_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lock_free_clock_replacer.h
+//
+// Identification: src/include/buffer/lock_free_clock_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>  // NOLINT
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+#include "buffer/replacer.h"
+
+namespace bustub {
+
+/**
+ * LockFreeClockReplacer implements the same clock replacement policy as ClockReplacer without a latch.
+ *
+ * The exist and ref flags of all frames are packed into a bitmap of atomic words, two bits per frame. Pin and Unpin
+ * are a single atomic and/or on the word of the frame, so the hit and unpin paths of the buffer pool manager never
+ * block on the replacer. Only Victim coordinates: it advances the clock hand with a compare-and-swap, so concurrent
+ * evictors follow one hand, and evicts a frame by clearing its exist bit with a compare-and-swap, so that it never
+ * evicts a frame which was pinned or referenced in the meantime.
+ */
+class LockFreeClockReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LockFreeClockReplacer.
+   * @param num_pages the maximum number of pages the LockFreeClockReplacer will be required to store
+   */
+  explicit LockFreeClockReplacer(size_t num_pages);
+
+  /**
+   * Destroys the LockFreeClockReplacer.
+   */
+  ~LockFreeClockReplacer() override;
+
+  /**
+   * Starting from the clock hand, find the first frame that is in the replacer with its ref flag unset. The ref flags
+   * of frames passed on the way are cleared. Gives up after sweeping the clock a few times while concurrent
+   * references keep every frame referenced.
+   * @param[out] frame_id the victim frame
+   * @return true for frame victimized, otherwise false
+   */
+  bool Victim(frame_id_t *frame_id) override;
+
+  /**
+   * Remove the frame from the replacer.
+   * @param frame_id the frame which was pinned
+   */
+  void Pin(frame_id_t frame_id) override;
+
+  /**
+   * Add the frame to the replacer with its ref flag set.
+   * @param frame_id the frame whose pin count dropped to 0
+   */
+  void Unpin(frame_id_t frame_id) override;
+
+  /** @return the number of frames that are currently in the replacer */
+  size_t Size() override;
+
+  /**
+   * Limit the clock to the frames [0, num_frames), frames beyond it are no victims any more.
+   * @param num_frames the new number of frames
+   */
+  void SetNumFrames(size_t num_frames) override {
+    assert(num_frames > 0 && num_frames <= num_pages_);
+    num_frames_ = num_frames;
+  }
+
+  /** @return the clock hand, the victim search starts there */
+  frame_id_t NextVictimHint() override { return static_cast<frame_id_t>(clock_hand_.load() % num_frames_.load()); }
+
+ private:
+  using word_t = uint64_t;
+  /** Each frame has an exist bit and a ref bit. */
+  static constexpr size_t BITS_PER_FRAME = 2;
+  static constexpr size_t FRAMES_PER_WORD = sizeof(word_t) * 8 / BITS_PER_FRAME;
+  /** Number of times Victim sweeps the clock before it gives up. */
+  static constexpr size_t MAX_SWEEPS = 3;
+
+  /** @return the word holding the flags of the frame */
+  std::atomic<word_t> &WordOf(frame_id_t frame_id) { return bitmap_[frame_id / FRAMES_PER_WORD]; }
+  /** @return the exist bit of the frame within its word */
+  static word_t ExistBit(frame_id_t frame_id) {
+    return static_cast<word_t>(1) << (frame_id % FRAMES_PER_WORD * BITS_PER_FRAME);
+  }
+  /** @return the ref bit of the frame within its word */
+  static word_t RefBit(frame_id_t frame_id) { return ExistBit(frame_id) << 1; }
+
+  /** Number of frames the bitmap has room for. */
+  const size_t num_pages_;
+  /** Number of frames the clock sweeps over, at most num_pages_. */
+  std::atomic<size_t> num_frames_;
+  /** Exist and ref flags of all frames. */
+  std::unique_ptr<std::atomic<word_t>[]> bitmap_;
+  /** Number of frames whose exist bit is set. It may lag behind the bitmap, but never for long. */
+  std::atomic<int64_t> size_{0};
+  /** Monotonic clock hand, the position is clock_hand_ % num_frames_. Only advanced by Victim. */
+  std::atomic<size_t> clock_hand_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin is a reference to the frame, stamped with a logical clock. The victim is the evictable frame with the
+ * largest backward K-distance, i.e. the oldest K-th most recent reference. Frames with fewer than K references have
+ * an infinite K-distance and are evicted first, oldest first reference first. Pages touched once by a scan are
+ * therefore evicted before pages of the working set which were referenced K times.
+ *
+ * A reference within correlated_period ticks of the frame's previous reference is correlated with it (e.g. a scan
+ * fetching one page per tuple): it only refreshes the last reference and does not count towards K. Frames referenced
+ * within the correlated period are only evicted if no other frame is evictable.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references tracked per frame
+   * @param correlated_period references closer than this many ticks are correlated; 0 = no correlated references
+   */
+  LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  /**
+   * Remove the evictable frame with the largest backward K-distance. Its history is kept until Load, see Reinstate.
+   * @param[out] frame_id the victim frame
+   * @return true for frame victimized, otherwise false
+   */
+  bool Victim(frame_id_t *frame_id) override;
+
+  /**
+   * Record a reference to the frame and make it non-evictable.
+   * @param frame_id the frame which was pinned
+   */
+  void Pin(frame_id_t frame_id) override;
+
+  /**
+   * Forget the history of the frame's previous page and stamp the load time, the frame ages from there until its first
+   * reference. A prefetched frame may be unpinned before it is referenced at all.
+   * @param frame_id the frame the page was loaded into
+   * @param page_id the loaded page
+   */
+  void Load(frame_id_t frame_id, page_id_t page_id) override;
+
+  /**
+   * Make the frame evictable.
+   * @param frame_id the frame whose pin count dropped to 0
+   */
+  void Unpin(frame_id_t frame_id) override;
+
+  /**
+   * Make the frame non-evictable and forget its history, the frame no longer holds a page.
+   * @param frame_id the frame of the deleted page
+   */
+  void Remove(frame_id_t frame_id) override;
+
+  /** @return the number of evictable frames */
+  size_t Size() override;
+
+  /** @return the frame which would be victimized next, 0 if no frame is evictable */
+  frame_id_t NextVictimHint() override;
+
+  /**
+   * Order frames by descending eviction order: frames with K references and the most recent K-th reference first.
+   * @param[in,out] frame_ids the frames to order
+   */
+  void SortByHotness(std::vector<frame_id_t> *frame_ids) override;
+
+ private:
+  /** Eviction order: frames with fewer than K references first, then by ascending K-th most recent reference. */
+  using evict_key_t = std::tuple<bool, uint64_t, frame_id_t>;
+
+  struct FrameInfo {
+    /** Timestamps of the last K uncorrelated references, most recent at the back. */
+    std::deque<uint64_t> history_;
+    /** Timestamp of the last reference, correlated or not. */
+    uint64_t last_ = 0;
+    /** True if the frame is in evictable_. */
+    bool evictable_ = false;
+  };
+
+  /** @return the position of the frame in the eviction order */
+  evict_key_t EvictKeyOf(frame_id_t frame_id) const;
+
+  const size_t k_;
+  const uint64_t correlated_period_;
+  /** Logical clock, advanced on every reference. */
+  uint64_t current_timestamp_ = 0;
+  std::vector<FrameInfo> frames_;
+  /** Evictable frames in eviction order. */
+  std::set<evict_key_t> evictable_;
+  /** Latch */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
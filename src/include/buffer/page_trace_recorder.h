@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_trace_recorder.h
+//
+// Identification: src/include/buffer/page_trace_recorder.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The buffer pool operation which referenced a page. */
+enum class PageTraceOp : uint32_t { FETCH, NEW };
+
+/** A page reference in a trace file. Trace files are a plain array of these records, in native byte order. */
+struct PageTraceRecord {
+  /** Microseconds since the trace was started. */
+  uint64_t timestamp_;
+  page_id_t page_id_;
+  PageTraceOp op_;
+};
+static_assert(sizeof(PageTraceRecord) == 16);
+
+/**
+ * PageTraceRecorder writes the page references of a buffer pool manager to a trace file, so that pool sizes and
+ * replacement policies can be evaluated offline against real workloads, see PageTraceSimulator.
+ *
+ * Records are buffered in memory and appended to the file in blocks. Record is thread safe and may race with Stop,
+ * references after Stop are dropped. When not recording, the only cost for the buffer pool is IsRecording().
+ */
+class PageTraceRecorder {
+ public:
+  PageTraceRecorder() = default;
+
+  /** Stops recording. */
+  ~PageTraceRecorder();
+
+  DISALLOW_COPY_AND_MOVE(PageTraceRecorder);
+
+  /**
+   * Start recording into a file, which is truncated. A running trace is stopped first.
+   * @param file_name the trace file
+   * @return false if the file could not be opened
+   */
+  bool Start(const std::string &file_name);
+
+  /** Stop recording, and write the buffered records to the file. */
+  void Stop();
+
+  /** @return true if page references are being recorded */
+  bool IsRecording() const { return recording_.load(std::memory_order_relaxed); }
+
+  /**
+   * Record a page reference.
+   * @param page_id the referenced page
+   * @param op the operation which referenced it
+   */
+  void Record(page_id_t page_id, PageTraceOp op);
+
+  /**
+   * Read a trace file.
+   * @param file_name the trace file
+   * @param[out] trace the records of the file
+   * @return false if the file could not be read
+   */
+  static bool ReadTrace(const std::string &file_name, std::vector<PageTraceRecord> *trace);
+
+ private:
+  /** Number of records buffered before they are written to the file. */
+  static constexpr size_t BUFFER_SIZE = 4096;
+
+  /** Write the buffered records to the file, the latch must be held. */
+  void WriteBuffer();
+
+  std::atomic<bool> recording_{false};
+  /** Protects the members below. */
+  std::mutex latch_;
+  std::ofstream file_;
+  std::vector<PageTraceRecord> buffer_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_trace_simulator.h
+//
+// Identification: src/include/buffer/page_trace_simulator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/page_trace_recorder.h"
+
+namespace bustub {
+
+/**
+ * PageTraceSimulator replays a page trace against the replacers of the buffer pool manager, without any I/O.
+ *
+ * It models a buffer pool in which every reference pins and immediately unpins its page, and the replacer is notified
+ * exactly as by the buffer pool manager. The miss ratio is the fraction of FetchPage references which had to read
+ * their page from disk. NewPage references never read, but they take a frame like a miss does.
+ */
+class PageTraceSimulator {
+ public:
+  /**
+   * Create a simulator for a trace.
+   * @param trace the page references, e.g. read by PageTraceRecorder::ReadTrace
+   */
+  explicit PageTraceSimulator(std::vector<PageTraceRecord> trace);
+
+  /**
+   * Replay the trace against a buffer pool.
+   * @param replacer_type the replacement policy
+   * @param pool_size the number of frames, at least 1
+   * @return the miss ratio of the fetches, 0 if the trace has no fetches
+   */
+  double MissRatio(BufferPoolManager::ReplacerType replacer_type, size_t pool_size) const;
+
+  /**
+   * Replay the trace against a buffer pool of every size.
+   * @param replacer_type the replacement policy
+   * @param pool_sizes the number of frames of each run
+   * @return the miss ratio of each pool size
+   */
+  std::vector<double> MissRatioCurve(BufferPoolManager::ReplacerType replacer_type,
+                                     const std::vector<size_t> &pool_sizes) const;
+
+  /** @return the number of distinct pages in the trace, the smallest pool which only has compulsory misses */
+  size_t GetNumDistinctPages() const { return num_distinct_pages_; }
+
+ private:
+  const std::vector<PageTraceRecord> trace_;
+  size_t num_distinct_pages_;
+};
+
+}  // namespace bustub
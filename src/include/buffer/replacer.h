@@ -12,12 +12,18 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
 /**
  * Replacer is an abstract class that tracks page usage.
+ * Implementations must be thread safe: the buffer pool manager notifies Pin/Unpin concurrently from its
+ * hit and unpin paths, so a frame returned by Victim may already be pinned again and is validated by the caller.
  */
 class Replacer {
  public:
@@ -43,8 +49,57 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Removes a frame whose page was deleted, it holds no page until it is handed out again.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Undoes a Victim whose frame the buffer pool did not claim, e.g. because a hit pinned it again meanwhile: the frame
+   * keeps its page. The frame becomes evictable with its next Unpin.
+   * @param frame_id the frame returned by Victim
+   */
+  virtual void Reinstate([[maybe_unused]] frame_id_t frame_id) {}
+
+  /**
+   * Notifies the replacer that a page was loaded into a frame, before the frame is pinned for it.
+   * Replacers which keep history of evicted pages use it to recognize pages coming back.
+   * @param frame_id the id of the frame
+   * @param page_id the id of the page loaded into the frame
+   */
+  virtual void Load([[maybe_unused]] frame_id_t frame_id, [[maybe_unused]] page_id_t page_id) {}
+
+  /**
+   * Notifies the replacer that the buffer pool was resized to num_frames frames. Frames at or beyond num_frames are
+   * drained by the buffer pool and are not unpinned again. Policies which depend on the pool size adapt to it.
+   * @param num_frames the new number of frames, at most the number of pages the replacer was created for
+   */
+  virtual void SetNumFrames([[maybe_unused]] size_t num_frames) {}
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;  // TODO(jigao): can be const
+
+  /**
+   * The page cleaner writes back dirty frames starting here, so that the next victims are already clean.
+   * @return the frame the replacer inspects first when looking for the next victim, 0 if it has no scan order
+   */
+  virtual frame_id_t NextVictimHint() { return 0; }
+
+  /**
+   * Order frames from the hottest to the coldest, i.e. by how long the replacer would keep them. Used for the warm-up
+   * snapshot of the buffer pool. By default, frames are ordered by when the victim search starting at NextVictimHint
+   * reaches them: the frames it reaches last are the hottest.
+   * @param[in,out] frame_ids the frames to order
+   */
+  virtual void SortByHotness(std::vector<frame_id_t> *frame_ids) {
+    const int64_t start = NextVictimHint();
+    auto position = [start](frame_id_t frame_id) {
+      return frame_id >= start ? frame_id - start : frame_id - start + (INT64_C(1) << 32);
+    };
+    std::sort(frame_ids->begin(), frame_ids->end(),
+              [&position](frame_id_t a, frame_id_t b) { return position(a) > position(b); });
+  }
 };
 
 }  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// swizzled_page_ref.h
+//
+// Identification: src/include/buffer/swizzled_page_ref.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class Page;
+
+/**
+ * SwizzledPageRef is an in-memory reference to a page which is followed over and over, e.g. from a hash table to its
+ * block pages.
+ *
+ * The reference always knows the page id. While the page is resident, it is swizzled: it also holds the frame of the
+ * page, and BufferPoolManager::FetchSwizzled pins that frame directly instead of looking the page up in the page
+ * table. A frame is swizzled by at most one reference at a time. When the page is evicted or deleted, the buffer pool
+ * unswizzles the reference before the frame is reused, and the next fetch goes through the page table again.
+ *
+ * The buffer pool keeps a pointer to a swizzled reference, so its owner must call BufferPoolManager::Unswizzle
+ * before destroying it, and must not move it.
+ */
+class SwizzledPageRef {
+  friend class BufferPoolManager;
+
+ public:
+  /**
+   * Create an unswizzled reference.
+   * @param page_id the referenced page
+   */
+  explicit SwizzledPageRef(page_id_t page_id) : page_id_(page_id) {}
+
+  ~SwizzledPageRef() = default;
+
+  DISALLOW_COPY_AND_MOVE(SwizzledPageRef);
+
+  /** @return the referenced page */
+  page_id_t GetPageId() const { return page_id_; }
+
+  /** @return true if the reference currently points to the frame of its page */
+  bool IsSwizzled() const { return frame_.load(std::memory_order_acquire) != nullptr; }
+
+ private:
+  /** The referenced page. */
+  const page_id_t page_id_;
+  /** The frame holding the page, nullptr if the reference is unswizzled. Written by the buffer pool only. */
+  std::atomic<Page *> frame_{nullptr};
+};
+
+}  // namespace bustub
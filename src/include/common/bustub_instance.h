@@ -23,7 +23,14 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * Creates a new BustubInstance.
+   * @param db_file_name the database file
+   * @param buffer_pool_size the initial size of the buffer pool
+   * @param max_buffer_pool_size the size the buffer pool can be resized to online, 0 = buffer_pool_size
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t buffer_pool_size = BUFFER_POOL_SIZE,
+                          size_t max_buffer_pool_size = 0) {
     enable_logging = false;
 
     // storage related
@@ -32,7 +39,9 @@ class BustubInstance {
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManager(buffer_pool_size, disk_manager_, log_manager_, 1,
+                                                 BufferPoolManager::ReplacerType::LOCK_FREE_CLOCK,
+                                                 max_buffer_pool_size);
 
     // txn related
     lock_manager_ = new LockManager(TwoPLMode::STRICT, DeadlockMode::PREVENTION);  // S2PL
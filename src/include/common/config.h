@@ -27,14 +27,48 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** If the page cleaner is running, it writes back dirty frames every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** A table iterator prefetches up to TABLE_READ_AHEAD_PAGES pages ahead of its cursor, 0 = no read-ahead. */
+extern size_t table_read_ahead_pages;
+
+/** If BUFFER_POOL_HUGE_PAGES is true, new buffer pools back their frame data with transparent huge pages. */
+extern bool buffer_pool_huge_pages;
+
+/** If ENABLE_POINTER_SWIZZLING is true, hash tables reach their block pages through swizzled page references. */
+extern bool enable_pointer_swizzling;
+
+/** New buffer pools stage up to WRITE_BACK_STAGING_PAGES dirty victims for asynchronous write-back, per shard.
+ *  0 = evictions write back dirty victims in the foreground. */
+extern size_t write_back_staging_pages;
+
+/** If ENABLE_IO_URING is true, new disk managers submit asynchronous I/O through io_uring when the kernel allows it,
+ *  otherwise through a pool of threads. */
+extern bool enable_io_uring;
+
+/** The page size is a build option, see BUSTUB_PAGE_SIZE in CMakeLists.txt. */
+#ifndef BUSTUB_PAGE_SIZE
+#define BUSTUB_PAGE_SIZE 4096
+#endif
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
-static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_SIZE = BUSTUB_PAGE_SIZE;                            // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window of LRU-K replacer
+static constexpr int REPLACER_CORRELATED_PERIOD = 1;                          // correlated refs of LRU-K and ARC
+static constexpr int BULK_ACCESS_RING_SIZE = 32;                              // frames of a scan's private ring
+static constexpr int OPTIMISTIC_READ_ATTEMPTS = 4;                            // before a reader latches the page
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;                               // max asynchronous I/Os in flight
+static constexpr int ASYNC_IO_THREADS = 8;                                    // threads of the fallback I/O pool
+
+static_assert(PAGE_SIZE >= 4096 && PAGE_SIZE <= 65536 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+              "the page size must be a power of two from 4096 to 65536");
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
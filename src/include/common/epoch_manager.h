@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.h
+//
+// Identification: src/include/common/epoch_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * EpochManager provides epoch-based reclamation for lock-free readers.
+ *
+ * Readers bracket every access to a shared structure with Enter() and Exit(). A writer which unlinked an object
+ * calls WaitForReaders(): it advances the global epoch and returns once every reader which entered during the
+ * previous epoch has left, after which no reader can still hold a reference to the unlinked object.
+ * Writers must be serialized by the caller.
+ */
+class EpochManager {
+ public:
+  /** A ticket identifies the reader counter a reader registered with. */
+  using ticket_t = uint64_t;
+
+  EpochManager() = default;
+  ~EpochManager() = default;
+
+  DISALLOW_COPY_AND_MOVE(EpochManager);
+
+  /**
+   * Register a reader in the current epoch.
+   * @return the ticket to be passed to Exit()
+   */
+  ticket_t Enter() {
+    const size_t stripe = ThreadStripe();
+    while (true) {
+      const uint64_t epoch = epoch_.load();
+      stripes_[stripe].readers_[epoch & 1].fetch_add(1);
+      // Validate the epoch, otherwise a writer might already be waiting on the other parity.
+      if (epoch_.load() == epoch) {
+        return (stripe << 1) | (epoch & 1);
+      }
+      stripes_[stripe].readers_[epoch & 1].fetch_sub(1);
+    }
+  }
+
+  /**
+   * Unregister a reader.
+   * @param ticket the ticket returned by Enter()
+   */
+  void Exit(ticket_t ticket) { stripes_[ticket >> 1].readers_[ticket & 1].fetch_sub(1); }
+
+  /**
+   * Advance the epoch and wait until all readers of the previous epoch have left.
+   */
+  void WaitForReaders() {
+    const uint64_t epoch = epoch_.fetch_add(1);
+    for (auto &stripe : stripes_) {
+      while (stripe.readers_[epoch & 1].load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t NUM_STRIPES = 64;
+
+  /** Reader counters of both epoch parities, padded to a cache line to avoid false sharing between threads. */
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t> readers_[2]{};
+  };
+
+  /** @return the reader counter stripe of the calling thread */
+  static size_t ThreadStripe() {
+    static thread_local const size_t stripe = std::hash<std::thread::id>()(std::this_thread::get_id()) % NUM_STRIPES;
+    return stripe;
+  }
+
+  std::atomic<uint64_t> epoch_{0};
+  Stripe stripes_[NUM_STRIPES];
+};
+
+}  // namespace bustub
@@ -45,6 +45,10 @@ enum class ExceptionType {
   INCOMPATIBLE_TYPE = 8,
   /** Method not implemented. */
   NOT_IMPLEMENTED = 11,
+  /** Out of memory error, e.g. every frame of the buffer pool is pinned. */
+  OUT_OF_MEMORY = 12,
+  /** Database file format error, e.g. a file of another page size, another format version, or a corrupt file. */
+  FILE_FORMAT = 13,
 };
 
 class Exception : public std::runtime_error {
@@ -61,6 +65,9 @@ class Exception : public std::runtime_error {
     std::cerr << exception_message;
   }
 
+  /** @return the type of the exception */
+  ExceptionType GetType() const { return type_; }
+
   std::string ExpectionTypeToString(ExceptionType type) {
     switch (type) {
       case ExceptionType::INVALID:
@@ -81,6 +88,10 @@ class Exception : public std::runtime_error {
         return "Incompatible type";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::OUT_OF_MEMORY:
+        return "Out of memory";
+      case ExceptionType::FILE_FORMAT:
+        return "File format";
       default:
         return "Unknown";
     }
@@ -12,25 +12,42 @@
 
 #pragma once
 
+#include <atomic>  // NOLINT
 #include <climits>
-#include <condition_variable>  // NOLINT
-#include <mutex>               // NOLINT
+#include <cstdint>
+#include <thread>  // NOLINT
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "common/macros.h"
 
 namespace bustub {
 
 /**
- * Reader-Writer latch backed by std::mutex.
+ * Reader-Writer latch backed by a single atomic word.
+ *
+ * The word holds the writer bit, a bit for parked threads, the number of waiting writers and the number of readers,
+ * so uncontended acquires and releases are a single atomic instruction. Contended acquires spin for a bounded number
+ * of rounds and then park on the word (a futex on Linux). Waiting writers block new readers, so writers cannot
+ * starve.
  */
 class ReaderWriterLatch {
-  using mutex_t = std::mutex;
-  using cond_t = std::condition_variable;
-  static const uint32_t MAX_READERS = UINT_MAX;
+  using state_t = uint32_t;
+  static constexpr state_t WRITER = 1U << 31;
+  static constexpr state_t PARKED = 1U << 30;
+  static constexpr state_t ONE_WAITING_WRITER = 1U << 16;
+  static constexpr state_t WAITING_WRITERS_MASK = PARKED - ONE_WAITING_WRITER;
+  static constexpr state_t MAX_READERS = ONE_WAITING_WRITER - 1;
+  /** Rounds of spinning before a thread parks. */
+  static constexpr int SPIN_ROUNDS = 64;
 
  public:
   ReaderWriterLatch() = default;
-  ~ReaderWriterLatch() { std::lock_guard<mutex_t> guard(mutex_); }  // NOLINT
+  ~ReaderWriterLatch() = default;
 
   DISALLOW_COPY(ReaderWriterLatch);
 
@@ -38,59 +55,142 @@ class ReaderWriterLatch {
    * Acquire a write latch.
    */
   void WLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_) {
-      reader_.wait(latch);
-    }
-    writer_entered_ = true;
-    while (reader_count_ > 0) {
-      writer_.wait(latch);
+    state_t expected = 0;
+    if (!state_.compare_exchange_strong(expected, WRITER, std::memory_order_acquire)) {
+      WLockSlow();
     }
   }
 
+  /**
+   * Try to acquire a write latch without waiting.
+   * @return true if the write latch was acquired, false if a reader or writer holds or waits for the latch
+   */
+  bool TryWLock() {
+    state_t expected = 0;
+    return state_.compare_exchange_strong(expected, WRITER, std::memory_order_acquire);
+  }
+
   /**
    * Release a write latch.
    */
   void WUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    writer_entered_ = false;
-    reader_.notify_all();
+    if ((state_.fetch_and(~(WRITER | PARKED), std::memory_order_release) & PARKED) != 0) {
+      WakeParked();
+    }
   }
 
   /**
    * Acquire a read latch.
    */
   void RLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_ || reader_count_ == MAX_READERS) {
-      reader_.wait(latch);
+    state_t state = state_.load(std::memory_order_relaxed);
+    if (!CanRead(state) || !state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+      RLockSlow();
+    }
+  }
+
+  /**
+   * Try to acquire a read latch without waiting.
+   * @return true if the read latch was acquired, false if a writer holds or waits for the latch
+   */
+  bool TryRLock() {
+    state_t state = state_.load(std::memory_order_relaxed);
+    while (CanRead(state)) {
+      if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+        return true;
+      }
     }
-    reader_count_++;
+    return false;
   }
 
   /**
    * Release a read latch.
    */
   void RUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    reader_count_--;
-    if (writer_entered_) {
-      if (reader_count_ == 0) {
-        writer_.notify_one();
+    const state_t state = state_.fetch_sub(1, std::memory_order_release);
+    // Only the last reader in front of a waiting writer, or a reader at the reader limit, can unblock anyone.
+    if ((state & PARKED) != 0 && ((state & MAX_READERS) == 1 || (state & MAX_READERS) == MAX_READERS)) {
+      state_.fetch_and(~PARKED, std::memory_order_relaxed);
+      WakeParked();
+    }
+  }
+
+ private:
+  /** @return true if a reader may enter in state: no writer holds or waits for the latch */
+  static bool CanRead(state_t state) {
+    return (state & (WRITER | WAITING_WRITERS_MASK)) == 0 && (state & MAX_READERS) != MAX_READERS;
+  }
+
+  void RLockSlow() {
+    for (int round = 0;; round++) {
+      state_t state = state_.load(std::memory_order_relaxed);
+      if (CanRead(state)) {
+        if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+          return;
+        }
+        continue;
       }
-    } else {
-      if (reader_count_ == MAX_READERS - 1) {
-        reader_.notify_one();
+      if (round < SPIN_ROUNDS) {
+        CpuRelax();
+      } else {
+        Park(state);
       }
     }
   }
 
- private:
-  mutex_t mutex_;
-  cond_t writer_;
-  cond_t reader_;
-  uint32_t reader_count_{0};
-  bool writer_entered_{false};
+  void WLockSlow() {
+    // Announce the writer, which keeps new readers out.
+    state_.fetch_add(ONE_WAITING_WRITER, std::memory_order_relaxed);
+    for (int round = 0;; round++) {
+      state_t state = state_.load(std::memory_order_relaxed);
+      if ((state & (WRITER | MAX_READERS)) == 0) {
+        if (state_.compare_exchange_weak(state, (state - ONE_WAITING_WRITER) | WRITER, std::memory_order_acquire)) {
+          return;
+        }
+        continue;
+      }
+      if (round < SPIN_ROUNDS) {
+        CpuRelax();
+      } else {
+        Park(state);
+      }
+    }
+  }
+
+  /**
+   * Sleep until the latch word changes from state. The parked bit tells the next release to wake us; a release
+   * between setting the bit and sleeping clears it, so the futex does not sleep at all.
+   */
+  void Park(state_t state) {
+    if ((state & PARKED) == 0 && !state_.compare_exchange_weak(state, state | PARKED, std::memory_order_relaxed)) {
+      return;
+    }
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<state_t *>(&state_), FUTEX_WAIT_PRIVATE, state | PARKED, nullptr, nullptr, 0);
+#else
+    std::this_thread::yield();
+#endif
+  }
+
+  /** Wake every parked thread. They retry to acquire the latch. */
+  void WakeParked() {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<state_t *>(&state_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+  }
+
+  static void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+  }
+
+  static_assert(sizeof(std::atomic<state_t>) == sizeof(state_t));
+
+  /** Writer bit, parked bit, waiting writers and readers. */
+  std::atomic<state_t> state_{0};
 };
 
 }  // namespace bustub
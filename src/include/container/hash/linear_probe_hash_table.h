@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <deque>
 #include <queue>
 #include <string>
 #include <vector>
@@ -56,6 +57,11 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   explicit LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                 const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn);
 
+  /**
+   * Destroys the hash table, unswizzling the references to its block pages.
+   */
+  ~LinearProbeHashTable() override;
+
   /**
    * Inserts a key-value pair into the hash table.
    * When hash table is full, throws the exception `hash_table_full_error`.
@@ -105,6 +111,8 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   slot_offset_t BLOCK_ARRAY_SIZE_LAST_PAGE;
   size_t size_cache;
   std::vector<page_id_t> page_ids_cache;
+  /** Swizzled references to the block pages, parallel to page_ids_cache. A deque keeps them in place on Resize. */
+  std::deque<SwizzledPageRef> block_page_refs_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   /** Readers includes inserts and removes, writer is only resize */
@@ -112,8 +120,34 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   /** Hash function */
   HashFunction<KeyType> hash_fn_;
 
+  /** Fetch and pin a block page, through its swizzled reference if ENABLE_POINTER_SWIZZLING is set. */
+  Page *FetchBlockPage(size_t page_index) {
+    if (enable_pointer_swizzling) {
+      return buffer_pool_manager_->FetchSwizzled(&block_page_refs_[page_index]);
+    }
+    return buffer_pool_manager_->FetchPage(page_ids_cache[page_index]);
+  }
+
+  /** Unpin a block page fetched by FetchBlockPage, without a page table lookup if ENABLE_POINTER_SWIZZLING is set. */
+  void UnpinBlockPage(Page *page, bool is_dirty) {
+    if (enable_pointer_swizzling) {
+      buffer_pool_manager_->UnpinSwizzled(page, is_dirty);
+    } else {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+    }
+  }
+
   bool Insert_Helper(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * Probe the slots of one block page from slot_offset on, collecting the values of key. Also used for optimistic
+   * reads, so it must not trust the page beyond its slot bounds.
+   * @return true if the probe ended in this block page, false if it continues in the next one
+   */
+  bool ProbeBlock(HashTableBlockPage<KeyType, ValueType, KeyComparator> *block_page, size_t page_index,
+                  slot_offset_t slot_offset, size_t page_index_start, slot_offset_t slot_offset_start,
+                  const KeyType &key, std::vector<ValueType> *result);
+
   std::pair<size_t, slot_offset_t> GetPagePosition(size_t hash_position) const {
     const size_t page_index = hash_position / BLOCK_ARRAY_SIZE_PRO_PAGE;
     const slot_offset_t slot_offset
@@ -54,10 +54,21 @@ class ExecutorContext {
   /** @return the lock manager - don't worry about it for now */
   LockManager *GetLockManager() { return nullptr; }
 
+  /**
+   * Let sequential scans and inserts read and write through a bulk buffer access strategy, i.e. a private ring of
+   * frames, so that they cannot flush the shared buffer pool.
+   * @param bulk_access true to use a bulk access strategy
+   */
+  void SetBulkAccess(bool bulk_access) { bulk_access_ = bulk_access; }
+
+  /** @return true if sequential scans and inserts use a bulk buffer access strategy */
+  bool IsBulkAccess() const { return bulk_access_; }
+
  private:
   Transaction *transaction_;
   SimpleCatalog *catalog_;
   BufferPoolManager *bpm_;
+  bool bulk_access_{false};
 };
 
 }  // namespace bustub
@@ -62,6 +62,9 @@ class HashJoinExecutor : public AbstractExecutor {
   HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan, std::unique_ptr<AbstractExecutor> &&left,
                    std::unique_ptr<AbstractExecutor> &&right);
 
+  /** Deletes the tmp tuple pages of the hash table, so that their page ids are reused. */
+  ~HashJoinExecutor() override;
+
   /** @return the JHT in use. Do not modify this function, otherwise you will get a zero. */
   const HT *GetJHT() const { return &jht_; }
 
@@ -94,6 +97,16 @@ class HashJoinExecutor : public AbstractExecutor {
   }
 
  private:
+  /**
+   * Read a left tuple from its pinned tmp tuple page and join it with the right tuple if the predicate holds.
+   * @param tmp_tuple_page the pinned tmp tuple page holding the left tuple
+   * @param left_tmp_tuple the location of the left tuple
+   * @param right_tuple the probing right tuple
+   * @param[out] tuple the output tuple, only set if the tuples joined
+   * @return true if the tuples joined
+   */
+  bool JoinTuples(Page *tmp_tuple_page, const TmpTuple &left_tmp_tuple, const Tuple &right_tuple, Tuple *tuple);
+
   /** The hash join plan node. */
   const HashJoinPlanNode *plan_;
   /** left keys */
@@ -106,6 +119,8 @@ class HashJoinExecutor : public AbstractExecutor {
   IdentityHashFunction jht_hash_fn_{};
   /** The hash table that we are using. */
   HT jht_;
+  /** The tmp tuple pages holding the left tuples, deleted with the executor. */
+  std::vector<page_id_t> tmp_tuple_page_ids_;
   /** if hash table built TODO(jigao): replaced by size() */
   bool jht_built_{false};
   /** The number of buckets in the hash table. */
@@ -12,11 +12,13 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_page_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -39,12 +41,16 @@ class SeqScanExecutor : public AbstractExecutor {
 
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
   /** get the table iterator */
-  TableIterator GetTableIterator() const { return table_iterator; }
+  const TablePageIterator &GetTableIterator() const { return table_iterator; }
 
  private:
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
-  /** The table iterator for table sequential scan */
-  TableIterator table_iterator;
+  /** The buffer access strategy of a bulk scan, nullptr for normal access. Must outlive the table iterator. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
+  /** The table iterator for table sequential scan, it keeps the page of its cursor pinned */
+  TablePageIterator table_iterator;
+  /** The current tuple of the scan, in table schema. Its buffer is reused across tuples. */
+  Tuple original_tuple_;
 };
 }  // namespace bustub
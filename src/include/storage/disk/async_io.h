@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.h
+//
+// Identification: src/include/storage/disk/async_io.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+/**
+ * A vectored read or write of a file, submitted to an AsyncIOBackend.
+ */
+struct AsyncIORequest {
+  /** True for a write, false for a read. */
+  bool write_;
+  /** Offset of the first byte in the file. */
+  int64_t offset_;
+  /** The buffers, filled or written one after the other. They must stay valid until the request completes. */
+  std::vector<iovec> iov_;
+  /** Called once the request completed, with the number of bytes transferred or -errno. */
+  std::function<void(int64_t)> on_complete_;
+};
+
+/**
+ * AsyncIOBackend runs reads and writes of a file asynchronously, so that a single thread can keep many requests in
+ * flight. Completions are reported through the callback of every request, on a thread of the backend: callbacks
+ * should be short and must not submit requests themselves.
+ */
+class AsyncIOBackend {
+ public:
+  virtual ~AsyncIOBackend() = default;
+
+  /**
+   * Submit a batch of requests at once. Blocks while queue_depth requests are in flight.
+   * @param requests the requests, owned by the backend until they complete
+   */
+  virtual void Submit(std::vector<std::unique_ptr<AsyncIORequest>> *requests) = 0;
+
+  /** @return the name of the backend */
+  virtual const char *GetName() const = 0;
+
+  /**
+   * Create the backend for a file: io_uring if enable_io_uring is set and the kernel allows it, otherwise a pool of
+   * threads doing blocking preadv and pwritev.
+   * @param fd the file, it must stay open until the backend is destroyed
+   * @param queue_depth the maximum number of requests in flight
+   * @return the backend
+   */
+  static std::unique_ptr<AsyncIOBackend> Create(int fd, size_t queue_depth);
+};
+
+/**
+ * The io_uring backend: requests are queued in the submission ring and submitted with one system call per batch.
+ * A completion thread reaps the completion ring. Uses the raw system calls, liburing is not needed.
+ */
+class IoUringBackend : public AsyncIOBackend {
+ public:
+  /**
+   * Set up the rings, see IsValid.
+   * @param fd the file
+   * @param queue_depth the number of entries of the submission ring and the maximum number of requests in flight
+   */
+  IoUringBackend(int fd, size_t queue_depth);
+
+  /** Wait for the requests in flight, then stop the completion thread and tear down the rings. */
+  ~IoUringBackend() override;
+
+  /** @return false if io_uring is not available, e.g. because of an old kernel or a seccomp filter */
+  bool IsValid() const { return ring_fd_ >= 0; }
+
+  void Submit(std::vector<std::unique_ptr<AsyncIORequest>> *requests) override;
+
+  const char *GetName() const override { return "io_uring"; }
+
+ private:
+  /** Queue a request into the submission ring. Should be called with latch_ held. */
+  void QueueRequest(AsyncIORequest *request, bool nop);
+
+  /** Submit the queued requests to the kernel. Should be called with latch_ held. */
+  void SubmitQueued();
+
+  /** Reap completions until the stop request completes. Run by the completion thread. */
+  void ReapCompletions();
+
+  const int fd_;
+  int ring_fd_ = -1;
+  /** The rings mapped from the kernel. */
+  void *sq_ring_ = nullptr;
+  void *cq_ring_ = nullptr;
+  void *sqes_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  size_t cq_ring_size_ = 0;
+  size_t sqes_size_ = 0;
+  /** Pointers into the rings. */
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  void *cqes_ = nullptr;
+  /** Number of entries of the submission ring, requests in flight never exceed it. */
+  size_t queue_depth_ = 0;
+
+  /** Protects the submission ring and num_in_flight_. */
+  std::mutex latch_;
+  /** Wakes up submitters waiting for room in the ring, and the destructor waiting for the requests in flight. */
+  std::condition_variable cv_;
+  size_t num_in_flight_ = 0;
+  /** Requests queued into the submission ring but not submitted yet. */
+  unsigned num_queued_ = 0;
+  std::thread *completion_thread_ = nullptr;
+};
+
+/**
+ * The fallback backend: a pool of threads doing blocking preadv and pwritev, one request per thread at a time.
+ */
+class ThreadPoolIOBackend : public AsyncIOBackend {
+ public:
+  /**
+   * Start the threads.
+   * @param fd the file
+   * @param num_threads the number of threads, which is the number of requests in flight
+   */
+  ThreadPoolIOBackend(int fd, size_t num_threads);
+
+  /** Finish the queued requests, then stop the threads. */
+  ~ThreadPoolIOBackend() override;
+
+  void Submit(std::vector<std::unique_ptr<AsyncIORequest>> *requests) override;
+
+  const char *GetName() const override { return "thread pool"; }
+
+ private:
+  /** Run queued requests until stopped. Run by every thread of the pool. */
+  void RunRequests();
+
+  const int fd_;
+  std::vector<std::thread> threads_;
+  /** Protects queue_ and stop_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<AsyncIORequest>> queue_;
+  bool stop_ = false;
+};
+
+}  // namespace bustub
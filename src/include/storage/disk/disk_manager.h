@@ -14,25 +14,56 @@
 
 #include <string>  // NOLINT
 #include <atomic>  // NOLINT
+#include <cstdlib>  // NOLINT
 #include <fstream>  // NOLINT
+#include <functional>  // NOLINT
 #include <future>  // NOLINT
-#include <shared_mutex>  // NOLINT
+#include <memory>  // NOLINT
+#include <mutex>  // NOLINT
+#include <vector>  // NOLINT
 
 #include "common/config.h"  // NOLINT
+#include "dynamic_bitset/dynamic_bitset.h"  // NOLINT
+#include "storage/disk/async_io.h"  // NOLINT
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The database file starts with a superblock of PAGE_SIZE bytes, which records the page size the database was
+ * created with, the high-water mark of the allocated page ids and the root page of the catalog, followed by a copy
+ * of it. The pages follow in groups of PAGES_PER_BITMAP, each group behind a bitmap page which records which pages of
+ * the group are allocated:
+ *
+ *   | superblock | copy | bitmap 0 | page 0 | ... | page P-1 | bitmap 1 | page P | ... | page 2P-1 | bitmap 2 | ...
+ *
+ * The superblock is updated with a double-write: the copy is written and synced first, then the superblock itself.
+ * A torn superblock fails its checksum, and the copy is used instead. Opening a database only reads the superblock.
+ *
+ * Freed pages are handed out again by AllocatePage. The bitmaps are read when the first page is allocated or freed.
+ * They are written lazily, but always before the pages they cover: a page never reaches the disk as allocated while
+ * the disk still records it as free.
+ *
+ * Pages are read and written with pread and pwrite at their own offsets, without a lock: concurrent requests of
+ * different threads reach the device concurrently. The buffer pool never reads a page while it writes it.
+ *
+ * Batches of pages can also be submitted asynchronously, see SubmitBatch. They go through io_uring, or through a pool
+ * of I/O threads where io_uring is not available, so that a single thread keeps many requests in flight.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io if true, pages bypass the OS page cache (O_DIRECT), so that they are not cached twice next to
+   * the buffer pool. Falls back to buffered I/O if the file system does not support it, see IsDirectIO.
+   * @throw Exception of type FILE_FORMAT if db_file exists but is not a database file, was written by a build older
+   * than the file header (see MigrateLegacyFile), its superblock and the copy are both corrupt, or it was created with
+   * a page size other than PAGE_SIZE
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
   ~DiskManager() = default;
 
@@ -55,6 +86,60 @@ class DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read several pages as one batch. The pages are read in page id order, and runs of consecutive pages are read with
+   * a single vectored read.
+   * @param page_ids ids of the pages
+   * @param[out] page_data page_data[i] is the output buffer of page_ids[i]
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /** A page read or write of a batch, see SubmitBatch. */
+  struct PageIO {
+    page_id_t page_id_;
+    /** The buffer of the page, it must stay valid until the page completed. */
+    char *page_data_;
+    /** True for a write, false for a read. */
+    bool write_;
+  };
+
+  /**
+   * Submit a batch of page reads and writes asynchronously. The pages are submitted in page id order, and runs of
+   * consecutive pages with the same operation become a single vectored request. A batch must not read a page it
+   * writes. After ShutDown, the batch runs synchronously.
+   * @param pages the pages to be read or written
+   * @param on_complete if set, called with the index of every page once the page completed, on an I/O thread
+   * @return a future which becomes ready once every page of the batch completed
+   */
+  std::future<void> SubmitBatch(const std::vector<PageIO> &pages, std::function<void(size_t)> on_complete = nullptr);
+
+  /**
+   * Read a page asynchronously, see SubmitBatch.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, it must stay valid until the future is ready
+   * @return a future which becomes ready once the page was read
+   */
+  std::future<void> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Write a page asynchronously, see SubmitBatch.
+   * @param page_id id of the page
+   * @param page_data raw page data, it must stay valid until the future is ready
+   * @return a future which becomes ready once the page was written
+   */
+  std::future<void> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Make the pages written so far durable, with a single fdatasync of the database file.
+   */
+  void SyncDataFile();
+
+  /** @return the name of the backend of the asynchronous I/O: "io_uring", "thread pool", or "none" after ShutDown */
+  const char *GetAsyncIOBackend() {
+    AsyncIOBackend *const async_io = GetAsyncIO();
+    return async_io != nullptr ? async_io->GetName() : "none";
+  }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -72,17 +157,59 @@ class DiskManager {
   bool ReadLog(char *log_data, int size, int offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk. A freed page is reused before the file grows: the first free page behind the hint, or
+   * the lowest free page if there is none.
+   * @param hint a page the new page should be close to, e.g. its predecessor in a chain; INVALID_PAGE_ID = none
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID);
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that AllocatePage can hand it out again. Pages which are not allocated are ignored.
    * @param page_id id of the page to deallocate
    */
   void DeallocatePage(page_id_t page_id);
 
+  /**
+   * @return the high-water mark of the page ids handed out; every allocated page id is below it. After a crash, it may
+   * be up to HIGH_WATER_MARK_STEP beyond the last allocated page.
+   */
+  page_id_t GetNumAllocatedPages() const { return next_page_id_; }
+
+  /** @return the number of freed page ids below GetNumAllocatedPages, which AllocatePage will reuse */
+  size_t GetNumFreePages();
+
+  /**
+   * Read the page size recorded in the header of a database file, e.g. to pick the build matching a database.
+   * @param db_file the file name of the database file
+   * @return the page size the database was created with, 0 if the file does not exist or is not a database file
+   */
+  static uint32_t ReadFilePageSize(const std::string &db_file);
+
+  /**
+   * Convert a database file written by a build older than the file header, which holds page i at offset
+   * i * PAGE_SIZE, to the current file format. The pages keep their page ids. The original file is kept as
+   * db_file + ".legacy".
+   * @param db_file the file name of the database file, which must not be open
+   * @throw Exception if db_file already has a file header, is not a multiple of PAGE_SIZE, or can't be read
+   */
+  static void MigrateLegacyFile(const std::string &db_file);
+
+  /** @return the root page of the catalog recorded in the superblock, INVALID_PAGE_ID if none was set */
+  page_id_t GetCatalogRoot() const { return catalog_root_; }
+
+  /**
+   * Record the root page of the catalog in the superblock. The superblock is synced before this returns.
+   * @param page_id the root page of the catalog
+   */
+  void SetCatalogRoot(page_id_t page_id);
+
+  /** Number of page ids the high-water mark in the superblock is moved ahead of the allocations at a time. */
+  static constexpr page_id_t HIGH_WATER_MARK_STEP = 1024;
+
+  /** @return true if pages are read and written with direct I/O */
+  bool IsDirectIO() const { return direct_io_; }
+
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
 
@@ -92,6 +219,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of syncs of the database file, see SyncDataFile */
+  int GetNumSyncs() const { return num_syncs_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -106,15 +236,143 @@ class DiskManager {
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  /** Direct I/O needs buffers, file offsets and sizes aligned to the logical block size of the device. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+  static_assert(PAGE_SIZE % DIRECT_IO_ALIGNMENT == 0);
+
+  /** Start of the first block of a database file, in every version of the file format. */
+  struct FileHeader {
+    char magic_[8];
+    uint32_t version_;
+    uint32_t page_size_;
+  };
+  static constexpr char FILE_MAGIC[sizeof(FileHeader::magic_) + 1] = "BUSTUBDB";
+  /** Version 2 added the allocation bitmaps, version 3 the superblock copy. Both moved the pages. */
+  static constexpr uint32_t FILE_VERSION = 3;
+
+  /** Start of the superblock and of its copy. The rest of the block is zero. */
+  struct Superblock {
+    FileHeader header_;
+    /** Every page id handed out is below it. Moved ahead of the allocations by HIGH_WATER_MARK_STEP. */
+    page_id_t high_water_mark_;
+    page_id_t catalog_root_;
+    /** Checksum of the fields above, to tell a torn superblock. */
+    uint64_t checksum_;
+  };
+
+  /** @return the checksum of a superblock */
+  static uint64_t SuperblockChecksum(const Superblock &superblock);
+
+  /** Number of pages whose allocation is recorded by one bitmap page, one bit per page. */
+  static constexpr page_id_t PAGES_PER_BITMAP = PAGE_SIZE * 8;
+
+  /** Offset of the copy of the superblock, which is written first. */
+  static constexpr int64_t SUPERBLOCK_COPY_OFFSET = PAGE_SIZE;
+
+  /** @return the offset of a page in the database file, behind the superblocks and the bitmap of its group */
+  static int64_t PageOffset(page_id_t page_id) {
+    return (static_cast<int64_t>(page_id) + page_id / PAGES_PER_BITMAP + 3) * PAGE_SIZE;
+  }
+
+  /** @return the offset of the bitmap page of a group of PAGES_PER_BITMAP pages */
+  static int64_t BitmapOffset(size_t group) {
+    return (static_cast<int64_t>(group) * (PAGES_PER_BITMAP + 1) + 2) * PAGE_SIZE;
+  }
+
+  /**
+   * Read the header block of a database file.
+   * @param db_file the file name of the database file
+   * @param[out] header the header
+   * @return false if the file does not exist or is not a database file
+   */
+  static bool ReadFileHeader(const std::string &db_file, FileHeader *header);
+
+  /**
+   * Read the superblock of an existing database file, or its copy if the superblock is torn.
+   * @param db_file the file name of the database file
+   * @param[out] superblock the superblock
+   * @param[out] torn true if the superblock is torn, and was read from the copy
+   * @return false if the file is empty, i.e. a new database
+   * @throw Exception of type FILE_FORMAT if the file is not a database file, both copies are corrupt, it was written by
+   * another version of the file format, or its page size is not PAGE_SIZE
+   */
+  static bool ReadSuperblock(const std::string &db_file, Superblock *superblock, bool *torn);
+
+  /**
+   * Write the superblock with a double-write: the copy first, then the superblock, each followed by a sync.
+   * Should be called with allocation_latch_ held.
+   * @param high_water_mark the high-water mark to record
+   */
+  void WriteSuperblock(page_id_t high_water_mark);
+
+  /**
+   * Read the bitmap pages of the db file on the first allocation or deallocation, and rebuild the free pages from
+   * them. Every page id below the high-water mark whose bit is clear is free.
+   * Should be called with allocation_latch_ held.
+   */
+  void LoadBitmaps();
+
+  /**
+   * Record the allocation of a page in the bitmap of its group, which becomes dirty.
+   * Should be called with allocation_latch_ held.
+   */
+  void SetAllocated(page_id_t page_id, bool allocated);
+
+  /**
+   * Write the dirty bitmap pages. Called before any page is written, so that the disk never holds an allocated page
+   * which its bitmap records as free, and before a sync.
+   */
+  void WriteDirtyBitmaps();
+
+  /** Maximum number of pages read or written by one vectored request of SubmitBatch. */
+  static constexpr size_t MAX_VECTORED_PAGES = 64;
+
+  /** @return true if the buffer cannot be used for direct I/O, and has to go through an aligned bounce buffer */
+  bool NeedsBounce(const char *page_data) const {
+    return direct_io_ && reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0;
+  }
+
+  /** Grow the cached file size to at least end, after a write. */
+  void GrowFileSize(int64_t end);
+
+  /** @return the asynchronous I/O backend, created by the first asynchronous request. nullptr after ShutDown. */
+  AsyncIOBackend *GetAsyncIO();
+
+  /** Descriptor of the db file, opened with O_DIRECT if direct_io_ is set. */
+  int db_fd_ = -1;
+  bool direct_io_ = false;
+  /** Size of the db file, cached so that reads do not stat the file. Grown by writes beyond the end of the file. */
+  std::atomic<int64_t> file_size_{0};
+  /** Runs the requests of SubmitBatch. Destroyed by ShutDown, before the db file is closed. */
+  std::unique_ptr<AsyncIOBackend> async_io_;
+  std::once_flag async_io_created_;
+  /** Set by ShutDown, the asynchronous I/O backend is gone from then on. */
+  std::atomic<bool> shut_down_{false};
   const std::string file_name_;
   std::atomic<page_id_t> next_page_id_;
+  /** Protects the allocation state and the superblock below, and next_page_id_ against concurrent allocations. */
+  std::mutex allocation_latch_;
+  /** The high-water mark recorded in the superblock on disk, at least next_page_id_. */
+  page_id_t durable_high_water_mark_ = 0;
+  std::atomic<page_id_t> catalog_root_{INVALID_PAGE_ID};
+  /** True while the superblock on disk is torn and only the copy is valid. */
+  bool superblock_torn_ = false;
+  bool bitmaps_loaded_ = false;
+  /** Bit i is set if page i, below next_page_id_, is free. */
+  dynamic_bitset<> free_pages_;
+  size_t num_free_pages_ = 0;
+  /** The bitmap page of every group as it is written to disk, aligned for direct I/O. A set bit marks an allocated
+   *  page. */
+  std::vector<std::unique_ptr<char, decltype(&free)>> bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  /** Number of dirty bitmap pages, checked without the latch before every write. Only drops once a bitmap is on
+   *  disk. */
+  std::atomic<size_t> num_dirty_bitmaps_{0};
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_syncs_{0};
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  mutable std::shared_mutex db_io_mutex_;
 };
 
 }  // namespace bustub
@@ -55,6 +55,15 @@ class HashTableBlockPage {
    */
   ValueType ValueAt(slot_offset_t bucket_ind) const;
 
+  /**
+   * Gets the key/value pair at an index in the block, without asserting that it is readable. Unlike KeyAt and
+   * ValueAt, this is safe during an optimistic read, where the index may stop being readable at any time.
+   *
+   * @param bucket_ind the index in the block to get the pair at
+   * @return the pair at index bucket_ind of the block, nullptr if the index is not readable
+   */
+  const MappingType *MappingAt(slot_offset_t bucket_ind) const;
+
   /**
    * Attempts to insert a key and value into an index in the block.
    * The insert is thread safe. It uses compare and swap to claim the index,
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <atomic>  // NOLINT
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,14 +27,17 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The book-keeping of all frames is a dense array, while the page data of all frames is one separate PAGE_SIZE-aligned
+ * region owned by the buffer pool manager, which attaches every frame to its slot of the region.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor for a standalone page outside the buffer pool, which owns its data. */
+  Page() : owned_data_(new char[PAGE_SIZE]{}) { data_ = owned_data_.get(); }
 
   /** Default destructor. */
   ~Page() = default;
@@ -43,23 +49,71 @@ class Page {
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() {
+    // A negative pin count marks a frame claimed by the buffer pool manager (free or being evicted): nobody pins it.
+    const int pin_count = pin_count_;
+    return pin_count < 0 ? 0 : pin_count;
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The page version is odd while a writer holds the latch. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** Try to acquire the page write latch without waiting. @return true if the latch was acquired */
+  inline bool TryWLatch() {
+    if (!rwlatch_.TryWLock()) {
+      return false;
+    }
+    version_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Try to acquire the page read latch without waiting. @return true if the latch was acquired */
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Begin an optimistic read, which reads the page without any latch. Waits until no writer holds the page.
+   * Everything read from the page may be torn until ValidateRead succeeds, so readers must bounds check offsets
+   * found in the page and must not act on what they read before validating.
+   * @return the page version to validate the read against
+   */
+  inline uint64_t BeginOptimisticRead() {
+    uint64_t version;
+    while (((version = version_.load(std::memory_order_acquire)) & 1) != 0) {
+      std::this_thread::yield();
+    }
+    return version;
+  }
+
+  /**
+   * Finish an optimistic read.
+   * @param version the version returned by BeginOptimisticRead
+   * @return true if no writer latched the page in the meantime, i.e. everything read is consistent
+   */
+  inline bool ValidateRead(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -75,19 +129,26 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Constructor for a buffer pool frame, whose data lives in the frame data region of the buffer pool manager. */
+  explicit Page(char *data) : data_(data) {}
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The actual data that is stored within a page, PAGE_SIZE bytes in the frame data region of the buffer pool. */
+  char *data_{nullptr};
+  /** The data of a standalone page, null for buffer pool frames. */
+  std::unique_ptr<char[]> owned_data_;
+  /** The ID of this page. Atomic, since lock-free buffer pool hits validate it after pinning. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /** The pin count of this page. Atomic, since buffer pool hits pin the page under a shared latch. */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Incremented whenever the write latch is acquired or released, so that optimistic readers detect writers. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -118,9 +118,21 @@ class TablePage : public Page {
    * @param[out] tuple the tuple that was read
    * @param txn transaction performing the read
    * @param lock_manager the lock manager
+   * @param zero_copy if true, point the tuple to its data in this page instead of copying it. The tuple is then only
+   * valid while the page stays pinned and nobody writes to it.
    * @return true if the read is successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager, bool zero_copy = false);
+
+  /**
+   * Copy a tuple out of the page during an optimistic read, i.e. without the page latch (see
+   * Page::BeginOptimisticRead). The slot may be torn by a concurrent writer, so offsets are bounds checked and the
+   * result is only meaningful once the read validates. Takes no tuple lock, so only usable with logging disabled.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple that was read
+   * @return true if the slot holds a tuple
+   */
+  bool ReadTupleOptimistic(const RID &rid, Tuple *tuple);
 
   /**
    * @param[out] first_rid the RID of the first tuple in this page
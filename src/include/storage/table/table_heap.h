@@ -26,6 +26,7 @@ namespace bustub {
  */
 class TableHeap {
   friend class TableIterator;
+  friend class TablePageIterator;
 
  public:
   ~TableHeap() = default;
@@ -55,9 +56,10 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the buffer access strategy of a bulk insert, nullptr = normal access
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -95,12 +97,17 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param strategy the buffer access strategy of a scan, nullptr = normal access
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy the buffer access strategy of the scan, nullptr = normal access. It must outlive the iterator.
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -109,6 +116,20 @@ class TableHeap {
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
  private:
+  /**
+   * Keep table_read_ahead_pages pages ahead of a scan in the buffer pool, when the scan enters a page.
+   * The page after the current one is known from its header. Table pages are usually allocated one after the other,
+   * so if it is the next page id, the following page ids are prefetched as well.
+   * A scan with a bulk access strategy does not read ahead: prefetched pages would land in the shared pool instead of
+   * the scan's ring.
+   * @param page_id the page the scan entered
+   * @param next_page_id the page following it
+   * @param[in,out] read_ahead_end the first page id which was not prefetched yet by the scan
+   * @param strategy the buffer access strategy of the scan, nullptr = normal access
+   */
+  void ReadAhead(page_id_t page_id, page_id_t next_page_id, page_id_t *read_ahead_end,
+                 BufferAccessStrategy *strategy = nullptr);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
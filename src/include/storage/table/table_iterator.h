@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -27,12 +28,14 @@ class TableHeap;
  */
 class TableIterator {
   friend class Cursor;
+  friend class TableHeap;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-  :table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+  :table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_), strategy_(other.strategy_),
+   read_ahead_end_(other.read_ahead_end_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,6 +55,10 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Buffer access strategy of the scan, nullptr = normal access. */
+  BufferAccessStrategy *strategy_;
+  /** The first page id which was not prefetched yet. */
+  page_id_t read_ahead_end_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_page_iterator.h
+//
+// Identification: src/include/storage/table/table_page_iterator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "buffer/buffer_access_strategy.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/page/table_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+class TableHeap;
+
+/**
+ * TablePageIterator scans a TableHeap one page at a time.
+ *
+ * Unlike TableIterator, which fetches the current page twice for every tuple, it keeps the page of its cursor pinned
+ * and yields all live tuples of that page before moving on to the next one. Tuples are either copied into the
+ * caller's tuple, reusing its buffer when the size matches, or handed out as zero-copy views into the pinned page.
+ */
+class TablePageIterator {
+ public:
+  /**
+   * Create an iterator positioned on the first tuple of the table.
+   * @param table_heap the table to scan
+   * @param txn the transaction performing the scan
+   * @param strategy the buffer access strategy of the scan, nullptr = normal access. It must outlive the iterator.
+   */
+  TablePageIterator(TableHeap *table_heap, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
+
+  ~TablePageIterator();
+
+  DISALLOW_COPY_AND_MOVE(TablePageIterator);
+
+  /**
+   * Advance the cursor to the next live tuple and copy it.
+   * @param[out] tuple the tuple that was read
+   * @return false if the scan is at its end
+   */
+  bool Next(Tuple *tuple) { return Next(tuple, false); }
+
+  /**
+   * Advance the cursor and return a view of the tuple under it, without copying it.
+   * The view is valid until the next call on this iterator. It is only consistent if nobody writes to the page in
+   * between, so it is meant for scans which do not run concurrently with writers of the table.
+   * @param[out] tuple the view of the tuple
+   * @return false if the scan is at its end
+   */
+  bool NextView(Tuple *tuple) { return Next(tuple, true); }
+
+  /**
+   * @return the RID under the cursor: the first slot in use before the first call, the last tuple returned afterwards,
+   * and RID(INVALID_PAGE_ID, 0) at the end of the scan
+   */
+  RID GetRid() const { return rid_; }
+
+  /** @return true if the scan is at its end */
+  bool IsEnd() const { return page_ == nullptr; }
+
+ private:
+  /**
+   * Move the cursor to the next live tuple and return it. Tuples marked as deleted are skipped.
+   * The cursor leaves its page lazily, on the call after returning the last tuple of the page, so that views of that
+   * tuple stay valid until then.
+   */
+  bool Next(Tuple *tuple, bool zero_copy);
+
+  /**
+   * Move the cursor to the first live tuple of the pages following the current one.
+   * The current page is read latched and pinned, and is released. On return, the new page is read latched and
+   * pinned, or page_ is nullptr if the scan reached its end.
+   */
+  void NextPage();
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  /** Buffer access strategy of the scan, nullptr = normal access. */
+  BufferAccessStrategy *strategy_;
+  /** The pinned page of the cursor, nullptr at the end of the scan. */
+  TablePage *page_{nullptr};
+  /** The cursor. */
+  RID rid_;
+  /** True if the tuple under the cursor was returned or skipped already. */
+  bool consumed_{false};
+  /** The first page id which was not prefetched yet. */
+  page_id_t read_ahead_end_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,253 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.cpp
+//
+// Identification: src/storage/disk/async_io.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_io.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define BUSTUB_HAS_IO_URING 1
+#endif
+
+#include "common/config.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+std::unique_ptr<AsyncIOBackend> AsyncIOBackend::Create(int fd, size_t queue_depth) {
+  if (enable_io_uring) {
+    auto io_uring = std::make_unique<IoUringBackend>(fd, queue_depth);
+    if (io_uring->IsValid()) {
+      return io_uring;
+    }
+    LOG_WARN("io_uring is not available, falling back to a thread pool for asynchronous I/O");
+  }
+  return std::make_unique<ThreadPoolIOBackend>(fd, ASYNC_IO_THREADS);
+}
+
+#ifdef BUSTUB_HAS_IO_URING
+
+IoUringBackend::IoUringBackend(int fd, size_t queue_depth) : fd_(fd) {
+  io_uring_params params{};
+  ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+  if (ring_fd_ < 0) {
+    return;
+  }
+  queue_depth_ = params.sq_entries;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  // Newer kernels map both rings with one mapping.
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap ? sq_ring_
+                         : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                IORING_OFF_CQ_RING);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    LOG_WARN("the io_uring rings could not be mapped");
+    close(ring_fd_);
+    ring_fd_ = -1;
+    return;
+  }
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  completion_thread_ = new std::thread(&IoUringBackend::ReapCompletions, this);
+}
+
+IoUringBackend::~IoUringBackend() {
+  if (ring_fd_ < 0) {
+    return;
+  }
+  {
+    // The completion thread stops at a no-op request, once everything before it completed.
+    std::unique_lock<std::mutex> lock(latch_);
+    cv_.wait(lock, [this] { return num_in_flight_ < queue_depth_; });
+    num_in_flight_++;
+    QueueRequest(nullptr, true);
+    SubmitQueued();
+  }
+  completion_thread_->join();
+  delete completion_thread_;
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+void IoUringBackend::Submit(std::vector<std::unique_ptr<AsyncIORequest>> *requests) {
+  std::unique_lock<std::mutex> lock(latch_);
+  for (auto &request : *requests) {
+    if (num_in_flight_ == queue_depth_) {
+      // The ring is full: hand the queued requests to the kernel, then wait for completions to make room.
+      SubmitQueued();
+      cv_.wait(lock, [this] { return num_in_flight_ < queue_depth_; });
+    }
+    num_in_flight_++;
+    QueueRequest(request.release(), false);
+  }
+  SubmitQueued();
+}
+
+void IoUringBackend::QueueRequest(AsyncIORequest *request, bool nop) {
+  // Only submitters write the tail, under latch_. The kernel reads it, so it is published with a release store.
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  if (nop) {
+    // The kernel completes requests out of order. Draining makes the no-op wait for every request queued before it.
+    sqe->opcode = IORING_OP_NOP;
+    sqe->flags |= IOSQE_IO_DRAIN;
+  } else {
+    sqe->opcode = request->write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(request->iov_.data());
+    sqe->len = static_cast<uint32_t>(request->iov_.size());
+    sqe->off = static_cast<uint64_t>(request->offset_);
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  num_queued_++;
+}
+
+void IoUringBackend::SubmitQueued() {
+  while (num_queued_ > 0) {
+    const auto submitted = syscall(__NR_io_uring_enter, ring_fd_, num_queued_, 0, 0, nullptr, 0);
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      LOG_ERROR("io_uring_enter failed: %s", strerror(errno));
+      return;
+    }
+    num_queued_ -= static_cast<unsigned>(submitted);
+  }
+}
+
+void IoUringBackend::ReapCompletions() {
+  bool stop = false;
+  while (true) {
+    if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+      LOG_ERROR("io_uring_enter failed: %s", strerror(errno));
+    }
+    // Only this thread moves the head of the completion ring.
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    size_t num_completed = 0;
+    for (; head != tail; head++) {
+      const io_uring_cqe *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+      auto *request = reinterpret_cast<AsyncIORequest *>(cqe->user_data);
+      if (request == nullptr) {
+        stop = true;
+      } else {
+        request->on_complete_(cqe->res);
+        delete request;
+      }
+      num_completed++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    std::lock_guard<std::mutex> lock(latch_);
+    if (num_completed > 0) {
+      num_in_flight_ -= num_completed;
+      cv_.notify_all();
+    }
+    // Stop only once the no-op and every request before it completed, their callers wait for the callbacks.
+    if (stop && num_in_flight_ == 0) {
+      return;
+    }
+  }
+}
+
+#else
+
+IoUringBackend::IoUringBackend(int fd, __attribute__((unused)) size_t queue_depth) : fd_(fd) {}
+
+IoUringBackend::~IoUringBackend() = default;
+
+void IoUringBackend::Submit(__attribute__((unused)) std::vector<std::unique_ptr<AsyncIORequest>> *requests) {}
+
+void IoUringBackend::QueueRequest(__attribute__((unused)) AsyncIORequest *request, __attribute__((unused)) bool nop) {}
+
+void IoUringBackend::SubmitQueued() {}
+
+void IoUringBackend::ReapCompletions() {}
+
+#endif
+
+ThreadPoolIOBackend::ThreadPoolIOBackend(int fd, size_t num_threads) : fd_(fd) {
+  for (size_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(&ThreadPoolIOBackend::RunRequests, this);
+  }
+}
+
+ThreadPoolIOBackend::~ThreadPoolIOBackend() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPoolIOBackend::Submit(std::vector<std::unique_ptr<AsyncIORequest>> *requests) {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    for (auto &request : *requests) {
+      queue_.push_back(std::move(request));
+    }
+  }
+  cv_.notify_all();
+}
+
+void ThreadPoolIOBackend::RunRequests() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    std::unique_ptr<AsyncIORequest> request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    const auto iovcnt = static_cast<int>(request->iov_.size());
+    const ssize_t result = request->write_ ? pwritev(fd_, request->iov_.data(), iovcnt, request->offset_)
+                                           : preadv(fd_, request->iov_.data(), iovcnt, request->offset_);
+    request->on_complete_(result < 0 ? -errno : result);
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
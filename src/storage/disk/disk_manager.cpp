@@ -10,14 +10,24 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>  // NOLINT
+#include <cstddef>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <numeric>
 #include <string>
 #include <thread>  // NOLINT
 
+#include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/hash_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -28,7 +38,7 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
+DiskManager::DiskManager(const std::string &db_file, bool direct_io)
     : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.find('.');
   if (n == std::string::npos) {
@@ -36,6 +46,9 @@ DiskManager::DiskManager(const std::string &db_file)
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  Superblock superblock{};
+  bool superblock_torn = false;
+  const bool existing = ReadSuperblock(db_file, &superblock, &superblock_torn);
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -48,15 +61,31 @@ DiskManager::DiskManager(const std::string &db_file)
     log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   }
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+    if (!direct_io_) {
+      LOG_WARN("direct I/O is not supported for %s, falling back to buffered I/O", db_file.c_str());
+    }
+  }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  struct stat stat_buf;
+  if (db_fd_ < 0 || fstat(db_fd_, &stat_buf) != 0) {
+    LOG_DEBUG("can't open db file");
+  } else {
+    file_size_ = stat_buf.st_size;
+    std::lock_guard<std::mutex> lock(allocation_latch_);
+    if (existing) {
+      next_page_id_ = durable_high_water_mark_ = superblock.high_water_mark_;
+      catalog_root_ = superblock.catalog_root_;
+    }
+    // A new database gets its superblock, a torn superblock is repaired from the copy.
+    superblock_torn_ = superblock_torn;
+    if (!existing || superblock_torn) {
+      WriteSuperblock(next_page_id_);
+    }
   }
   buffer_used = nullptr;
 }
@@ -65,7 +94,21 @@ DiskManager::DiskManager(const std::string &db_file)
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  // Waits for the asynchronous requests in flight. Later batches run synchronously, see SubmitBatch.
+  shut_down_ = true;
+  async_io_.reset();
+  if (db_fd_ >= 0) {
+    WriteDirtyBitmaps();
+    {
+      // A clean shutdown records the exact high-water mark, rather than the one moved ahead of the allocations.
+      std::lock_guard<std::mutex> lock(allocation_latch_);
+      if (durable_high_water_mark_ != next_page_id_) {
+        WriteSuperblock(next_page_id_);
+      }
+    }
+    close(db_fd_);
+    db_fd_ = -1;
+  }
   log_io_.close();
 }
 
@@ -73,45 +116,234 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  std::unique_lock u_lock(db_io_mutex_);
-  // set write cursor to offset
+  WriteDirtyBitmaps();
+  const int64_t offset = PageOffset(page_id);
+  // Buffer pool frames are aligned for direct I/O, other callers go through an aligned bounce buffer.
+  std::unique_ptr<char, decltype(&free)> bounce(nullptr, &free);
+  if (NeedsBounce(page_data)) {
+    bounce.reset(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE)));
+    memcpy(bounce.get(), page_data, PAGE_SIZE);
+    page_data = bounce.get();
+  }
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    u_lock.unlock();
+  // pwrite hands the page to the OS right away, like a flush of a stream would.
+  if (pwrite(db_fd_, page_data, PAGE_SIZE, offset) != PAGE_SIZE) {
     LOG_DEBUG("I/O error while writing");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-  u_lock.unlock();
+  GrowFileSize(offset + PAGE_SIZE);
+}
+
+/**
+ * Flush the pages written so far from the OS to the device
+ */
+void DiskManager::SyncDataFile() {
+  WriteDirtyBitmaps();
+  num_syncs_ += 1;
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+  const int64_t offset = PageOffset(page_id);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset >= file_size_) {
     LOG_DEBUG("I/O error while reading");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    std::unique_lock u_lock(db_io_mutex_);
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    u_lock.unlock();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  std::unique_ptr<char, decltype(&free)> bounce(nullptr, &free);
+  char *buffer = page_data;
+  if (NeedsBounce(page_data)) {
+    bounce.reset(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE)));
+    buffer = bounce.get();
+  }
+  ssize_t read_count = pread(db_fd_, buffer, PAGE_SIZE, offset);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    read_count = 0;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  }
+}
+
+/**
+ * Read several pages as one asynchronous batch, and wait for it.
+ */
+void DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  assert(page_ids.size() == page_data.size());
+  std::vector<PageIO> pages;
+  pages.reserve(page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    pages.push_back(PageIO{page_ids[i], page_data[i], false});
+  }
+  SubmitBatch(pages).get();
+}
+
+/**
+ * Submit the pages in page id order. Runs of consecutive pages with the same operation become one vectored request
+ * each; a page whose buffer is not aligned for direct I/O goes alone, through an aligned bounce buffer.
+ */
+std::future<void> DiskManager::SubmitBatch(const std::vector<PageIO> &pages, std::function<void(size_t)> on_complete) {
+  // Shared by the completions of the batch, the last one sets the promise.
+  struct BatchState {
+    std::promise<void> promise_;
+    std::atomic<size_t> remaining_;
+    std::function<void(size_t)> on_complete_;
+  };
+  auto state = std::make_shared<BatchState>();
+  state->remaining_ = pages.size();
+  state->on_complete_ = std::move(on_complete);
+  std::future<void> future = state->promise_.get_future();
+  auto complete = [state](const std::vector<size_t> &indices) {
+    if (state->on_complete_) {
+      for (const size_t i : indices) {
+        state->on_complete_(i);
+      }
+    }
+    if (state->remaining_.fetch_sub(indices.size()) == indices.size()) {
+      state->promise_.set_value();
+    }
+  };
+  if (pages.empty()) {
+    state->promise_.set_value();
+    return future;
+  }
+  // After ShutDown, e.g. for the write-back of a buffer pool destroyed later, the batch runs synchronously like
+  // ReadPage and WritePage.
+  AsyncIOBackend *const async_io = GetAsyncIO();
+  if (async_io == nullptr) {
+    for (size_t i = 0; i < pages.size(); i++) {
+      if (pages[i].write_) {
+        WritePage(pages[i].page_id_, pages[i].page_data_);
+      } else {
+        ReadPage(pages[i].page_id_, pages[i].page_data_);
+      }
+      complete({i});
+    }
+    return future;
+  }
+  WriteDirtyBitmaps();
+
+  std::vector<size_t> order(pages.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&pages](size_t a, size_t b) { return pages[a].page_id_ < pages[b].page_id_; });
+  std::vector<std::unique_ptr<AsyncIORequest>> requests;
+  size_t begin = 0;
+  while (begin < order.size()) {
+    const PageIO &first = pages[order[begin]];
+    const int64_t offset = PageOffset(first.page_id_);
+    // A read beyond the end of the file finds a zeroed page, like ReadPage.
+    if (!first.write_ && offset >= file_size_) {
+      LOG_DEBUG("I/O error while reading");
+      memset(first.page_data_, 0, PAGE_SIZE);
+      complete({order[begin]});
+      begin++;
+      continue;
     }
+    const bool bounce = NeedsBounce(first.page_data_);
+    size_t end = begin + 1;
+    while (!bounce && end < order.size() && end - begin < MAX_VECTORED_PAGES) {
+      const PageIO &next = pages[order[end]];
+      // The bitmap page of the next group separates it from the end of the previous one.
+      if (next.page_id_ != pages[order[end - 1]].page_id_ + 1 || next.page_id_ % PAGES_PER_BITMAP == 0 ||
+          next.write_ != first.write_ || NeedsBounce(next.page_data_)) {
+        break;
+      }
+      end++;
+    }
+    std::vector<size_t> run(order.begin() + begin, order.begin() + end);
+    std::vector<char *> data;
+    for (const size_t i : run) {
+      data.push_back(pages[i].page_data_);
+    }
+    auto request = std::make_unique<AsyncIORequest>();
+    request->write_ = first.write_;
+    request->offset_ = offset;
+    std::shared_ptr<char> bounce_buffer;
+    if (bounce) {
+      bounce_buffer.reset(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE)), &free);
+      if (first.write_) {
+        memcpy(bounce_buffer.get(), first.page_data_, PAGE_SIZE);
+      }
+      request->iov_.push_back(iovec{bounce_buffer.get(), PAGE_SIZE});
+    } else {
+      for (char *page_data : data) {
+        request->iov_.push_back(iovec{page_data, PAGE_SIZE});
+      }
+    }
+    if (first.write_) {
+      num_writes_ += static_cast<int>(run.size());
+    }
+    request->on_complete_ = [this, complete, run = std::move(run), data = std::move(data), bounce_buffer,
+                             write = first.write_, offset](int64_t result) {
+      if (result < 0) {
+        LOG_DEBUG("I/O error while %s", write ? "writing" : "reading");
+        result = 0;
+      }
+      if (write) {
+        GrowFileSize(offset + result);
+      } else {
+        if (bounce_buffer != nullptr) {
+          memcpy(data[0], bounce_buffer.get(), PAGE_SIZE);
+        }
+        // Zero the part of the run beyond the end of the file.
+        for (size_t i = 0; i < data.size(); i++) {
+          const auto page_offset = static_cast<int64_t>(i) * PAGE_SIZE;
+          if (result < page_offset + PAGE_SIZE) {
+            const int64_t valid = std::max<int64_t>(result - page_offset, 0);
+            memset(data[i] + valid, 0, PAGE_SIZE - valid);
+          }
+        }
+      }
+      complete(run);
+    };
+    requests.push_back(std::move(request));
+    begin = end;
+  }
+  if (!requests.empty()) {
+    async_io->Submit(&requests);
+  }
+  return future;
+}
+
+std::future<void> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  return SubmitBatch({PageIO{page_id, page_data, false}});
+}
+
+std::future<void> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  // The buffer is only read, the request just shares its type with reads.
+  return SubmitBatch({PageIO{page_id, const_cast<char *>(page_data), true}});
+}
+
+/**
+ * Private helper function to create the asynchronous I/O backend on first use, most disk managers never need it.
+ */
+AsyncIOBackend *DiskManager::GetAsyncIO() {
+  if (shut_down_) {
+    return nullptr;
+  }
+  std::call_once(async_io_created_, [this] { async_io_ = AsyncIOBackend::Create(db_fd_, ASYNC_IO_QUEUE_DEPTH); });
+  return async_io_.get();
+}
+
+/**
+ * Private helper function to keep the cached file size up to date. Concurrent writes may extend the file in any order.
+ */
+void DiskManager::GrowFileSize(int64_t end) {
+  int64_t file_size = file_size_.load();
+  while (file_size < end && !file_size_.compare_exchange_weak(file_size, end)) {
   }
 }
 
@@ -182,16 +414,174 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Reuse a freed page close to the hint if possible, otherwise grow the file
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(page_id_t hint) {
+  std::lock_guard<std::mutex> lock(allocation_latch_);
+  LoadBitmaps();
+  page_id_t page_id;
+  if (num_free_pages_ > 0) {
+    size_t free_page = dynamic_bitset<>::npos;
+    if (hint >= 0 && static_cast<size_t>(hint) < free_pages_.size()) {
+      free_page = free_pages_.test(hint) ? hint : free_pages_.find_next(hint);
+    }
+    if (free_page == dynamic_bitset<>::npos) {
+      free_page = free_pages_.find_first();
+    }
+    free_pages_.reset(free_page);
+    num_free_pages_--;
+    page_id = static_cast<page_id_t>(free_page);
+  } else {
+    if (next_page_id_ == durable_high_water_mark_) {
+      // The superblock has to cover every page id handed out, or the page would be handed out again after a crash.
+      WriteSuperblock(next_page_id_ + HIGH_WATER_MARK_STEP);
+    }
+    page_id = next_page_id_++;
+    free_pages_.push_back(false);
+    if (static_cast<size_t>(page_id / PAGES_PER_BITMAP) == bitmaps_.size()) {
+      // The first page of a new group.
+      bitmaps_.emplace_back(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE)), &free);
+      memset(bitmaps_.back().get(), 0, PAGE_SIZE);
+      bitmap_dirty_.push_back(false);
+    }
+  }
+  SetAllocated(page_id, true);
+  return page_id;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * The page is marked free in the bitmap of its group, it reaches the disk with the next write
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(allocation_latch_);
+  LoadBitmaps();
+  if (page_id < 0 || page_id >= next_page_id_ || free_pages_.test(page_id)) {
+    return;
+  }
+  free_pages_.set(page_id);
+  num_free_pages_++;
+  SetAllocated(page_id, false);
+}
+
+size_t DiskManager::GetNumFreePages() {
+  std::lock_guard<std::mutex> lock(allocation_latch_);
+  LoadBitmaps();
+  return num_free_pages_;
+}
+
+void DiskManager::SetCatalogRoot(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(allocation_latch_);
+  catalog_root_ = page_id;
+  WriteSuperblock(durable_high_water_mark_);
+}
+
+/**
+ * Private helper function to write the superblock with a double-write. Until the second write completed, the block
+ * written first holds the new superblock. Normally the copy is written first; while the superblock is torn, it is
+ * rewritten first, so that the valid copy survives a crash during the repair.
+ */
+void DiskManager::WriteSuperblock(page_id_t high_water_mark) {
+  Superblock superblock{};
+  memcpy(superblock.header_.magic_, FILE_MAGIC, sizeof(superblock.header_.magic_));
+  superblock.header_.version_ = FILE_VERSION;
+  superblock.header_.page_size_ = PAGE_SIZE;
+  superblock.high_water_mark_ = high_water_mark;
+  superblock.catalog_root_ = catalog_root_;
+  superblock.checksum_ = SuperblockChecksum(superblock);
+  std::unique_ptr<char, decltype(&free)> block(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE)),
+                                               &free);
+  memset(block.get(), 0, PAGE_SIZE);
+  memcpy(block.get(), &superblock, sizeof(superblock));
+  const int64_t first = superblock_torn_ ? 0 : SUPERBLOCK_COPY_OFFSET;
+  for (const int64_t offset : {first, SUPERBLOCK_COPY_OFFSET - first}) {
+    if (pwrite(db_fd_, block.get(), PAGE_SIZE, offset) != PAGE_SIZE || fdatasync(db_fd_) != 0) {
+      LOG_DEBUG("I/O error while writing the superblock");
+      return;
+    }
+  }
+  GrowFileSize(SUPERBLOCK_COPY_OFFSET + PAGE_SIZE);
+  superblock_torn_ = false;
+  durable_high_water_mark_ = high_water_mark;
+}
+
+uint64_t DiskManager::SuperblockChecksum(const Superblock &superblock) {
+  return HashUtil::HashBytes(reinterpret_cast<const char *>(&superblock), offsetof(Superblock, checksum_));
+}
+
+/**
+ * Private helper function to set or clear the bit of a page in the bitmap of its group
+ */
+void DiskManager::SetAllocated(page_id_t page_id, bool allocated) {
+  const size_t group = page_id / PAGES_PER_BITMAP;
+  const page_id_t bit = page_id % PAGES_PER_BITMAP;
+  char *const byte = bitmaps_[group].get() + bit / 8;
+  const auto mask = static_cast<char>(1 << (bit % 8));
+  *byte = static_cast<char>(allocated ? (*byte | mask) : (*byte & ~mask));
+  if (!bitmap_dirty_[group]) {
+    bitmap_dirty_[group] = true;
+    num_dirty_bitmaps_++;
+  }
+}
+
+/**
+ * Private helper function to write the dirty bitmap pages. Allocations and deallocations only dirty the bitmaps in
+ * memory, the next write of a page or sync writes them. A bitmap is clean only once it is written: until then,
+ * other writers see it dirty and wait on the latch, so that their pages do not reach the disk before it. A bitmap
+ * which could not be written stays dirty, and is retried with the next write.
+ */
+void DiskManager::WriteDirtyBitmaps() {
+  if (num_dirty_bitmaps_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(allocation_latch_);
+  for (size_t group = 0; group < bitmaps_.size(); group++) {
+    if (!bitmap_dirty_[group]) {
+      continue;
+    }
+    const int64_t offset = BitmapOffset(group);
+    if (pwrite(db_fd_, bitmaps_[group].get(), PAGE_SIZE, offset) != PAGE_SIZE) {
+      LOG_DEBUG("I/O error while writing a bitmap page");
+      continue;
+    }
+    GrowFileSize(offset + PAGE_SIZE);
+    bitmap_dirty_[group] = false;
+    num_dirty_bitmaps_--;
+  }
+}
+
+/**
+ * Private helper function to load the bitmap pages, once. A bitmap which was never written records a group of free
+ * pages, e.g. the pages between the last allocated one and the high-water mark after a crash.
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::LoadBitmaps() {
+  if (bitmaps_loaded_) {
+    return;
+  }
+  bitmaps_loaded_ = true;
+  const page_id_t high_water_mark = next_page_id_;
+  const page_id_t num_groups = (high_water_mark + PAGES_PER_BITMAP - 1) / PAGES_PER_BITMAP;
+  for (page_id_t group = 0; group < num_groups; group++) {
+    bitmaps_.emplace_back(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE)), &free);
+    bitmap_dirty_.push_back(false);
+    char *const bitmap = bitmaps_.back().get();
+    ssize_t read_count = pread(db_fd_, bitmap, PAGE_SIZE, BitmapOffset(group));
+    if (read_count < 0) {
+      LOG_DEBUG("I/O error while reading a bitmap page");
+      read_count = 0;
+    }
+    memset(bitmap + read_count, 0, PAGE_SIZE - read_count);
+  }
+  free_pages_.resize(high_water_mark);
+  for (page_id_t page_id = 0; page_id < high_water_mark; page_id++) {
+    const char *bitmap = bitmaps_[page_id / PAGES_PER_BITMAP].get();
+    const page_id_t bit = page_id % PAGES_PER_BITMAP;
+    if ((bitmap[bit / 8] & (1 << (bit % 8))) == 0) {
+      free_pages_.set(page_id);
+      num_free_pages_++;
+    }
+  }
+}
 
 /**
  * Returns number of flushes made so far
@@ -201,13 +591,110 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
 /**
  * Returns number of Writes made so far
  */
-int DiskManager::GetNumWrites() const { std::shared_lock s_lock(db_io_mutex_); return num_writes_; }
+int DiskManager::GetNumWrites() const { return num_writes_; }
 
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+uint32_t DiskManager::ReadFilePageSize(const std::string &db_file) {
+  FileHeader header{};
+  return ReadFileHeader(db_file, &header) ? header.page_size_ : 0;
+}
+
+void DiskManager::MigrateLegacyFile(const std::string &db_file) {
+  FileHeader header{};
+  if (ReadFileHeader(db_file, &header)) {
+    throw Exception(ExceptionType::FILE_FORMAT, db_file + " already has a file header");
+  }
+  struct stat stat_buf;
+  if (stat(db_file.c_str(), &stat_buf) != 0 || stat_buf.st_size % PAGE_SIZE != 0) {
+    throw Exception(ExceptionType::FILE_FORMAT, db_file + " is not a database file");
+  }
+  const std::string legacy_file = db_file + ".legacy";
+  if (rename(db_file.c_str(), legacy_file.c_str()) != 0) {
+    throw Exception(ExceptionType::FILE_FORMAT, "can't rename " + db_file + " to " + legacy_file);
+  }
+  // The legacy file holds page i at offset i * PAGE_SIZE. Allocating the pages of a new database in order keeps
+  // their page ids.
+  std::ifstream legacy(legacy_file, std::ios::binary | std::ios::in);
+  DiskManager disk_manager(db_file);
+  std::vector<char> data(PAGE_SIZE);
+  const auto num_pages = static_cast<page_id_t>(stat_buf.st_size / PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    if (!legacy.read(data.data(), PAGE_SIZE)) {
+      disk_manager.ShutDown();
+      throw Exception(ExceptionType::FILE_FORMAT, "I/O error while reading " + legacy_file);
+    }
+    disk_manager.AllocatePage();
+    disk_manager.WritePage(page_id, data.data());
+  }
+  disk_manager.ShutDown();
+}
+
+/**
+ * Private helper function to read the header block of a database file. Every version of the file format starts with
+ * the same header.
+ */
+bool DiskManager::ReadFileHeader(const std::string &db_file, FileHeader *header) {
+  std::ifstream file(db_file, std::ios::binary | std::ios::in);
+  return file.read(reinterpret_cast<char *>(header), sizeof(*header)) &&
+         memcmp(header->magic_, FILE_MAGIC, sizeof(header->magic_)) == 0;
+}
+
+/**
+ * Private helper function to read and check the superblock of an existing database file. Only a crash during the
+ * double-write of the superblock makes the copy needed, so opening a database normally reads a single block.
+ */
+bool DiskManager::ReadSuperblock(const std::string &db_file, Superblock *superblock, bool *torn) {
+  struct stat stat_buf;
+  if (stat(db_file.c_str(), &stat_buf) != 0 || stat_buf.st_size == 0) {
+    return false;
+  }
+  std::ifstream file(db_file, std::ios::binary | std::ios::in);
+  bool found = false;
+  *torn = false;
+  for (const int64_t offset : {int64_t{0}, SUPERBLOCK_COPY_OFFSET}) {
+    Superblock candidate{};
+    file.clear();
+    if (file.seekg(offset) && file.read(reinterpret_cast<char *>(&candidate), sizeof(candidate)) &&
+        memcmp(candidate.header_.magic_, FILE_MAGIC, sizeof(candidate.header_.magic_)) == 0 &&
+        candidate.checksum_ == SuperblockChecksum(candidate)) {
+      *superblock = candidate;
+      found = true;
+      break;
+    }
+    *torn = true;
+  }
+  // Without a valid superblock, the header of the first block tells why: another file, another build, another version
+  // of the file format, or a corrupt database.
+  FileHeader header = superblock->header_;
+  if (!found && !ReadFileHeader(db_file, &header)) {
+    if (stat_buf.st_size % PAGE_SIZE == 0) {
+      throw Exception(ExceptionType::FILE_FORMAT,
+                      db_file + " has no file header, it is not a database file or was written by a build older "
+                                "than the file header: DiskManager::MigrateLegacyFile converts the latter");
+    }
+    throw Exception(ExceptionType::FILE_FORMAT, db_file + " is not a database file");
+  }
+  if (header.page_size_ != static_cast<uint32_t>(PAGE_SIZE)) {
+    throw Exception(ExceptionType::FILE_FORMAT, db_file + " was created with a page size of " +
+                                                    std::to_string(header.page_size_) + " bytes, this build uses " +
+                                                    std::to_string(PAGE_SIZE));
+  }
+  if (header.version_ != FILE_VERSION) {
+    throw Exception(ExceptionType::FILE_FORMAT, db_file + " was written in version " +
+                                                    std::to_string(header.version_) +
+                                                    " of the file format, this build reads version " +
+                                                    std::to_string(FILE_VERSION));
+  }
+  if (!found) {
+    throw Exception(ExceptionType::FILE_FORMAT, db_file + " has a corrupt superblock and superblock copy");
+  }
+  return true;
+}
+
 /**
  * Private helper function to get disk file size
  */
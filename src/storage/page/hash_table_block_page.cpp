@@ -51,6 +51,11 @@ ValueType HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
   return array_[bucket_ind].second;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+const MappingType *HASH_TABLE_BLOCK_TYPE::MappingAt(slot_offset_t bucket_ind) const {
+  return GET_N_TH_BIT(readable_, bucket_ind) ? &array_[bucket_ind] : nullptr;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) {
   if (GET_N_TH_BIT(readable_, bucket_ind)) {
@@ -87,4 +92,17 @@ template class HashTableBlockPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class HashTableBlockPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class HashTableBlockPage<GenericKey<64>, RID, GenericComparator<64>>;
 
+// BLOCK_ARRAY_SIZE is derived from PAGE_SIZE, every block page layout must still fit into one page.
+template <typename KeyType, typename ValueType, typename KeyComparator>
+static constexpr bool BlockPageFits() {
+  return sizeof(HASH_TABLE_BLOCK_TYPE) + BLOCK_ARRAY_SIZE * sizeof(MappingType) <= PAGE_SIZE;
+}
+static_assert(BlockPageFits<int, int, IntComparator>());
+static_assert(BlockPageFits<hash_t, TmpTuple, HashComparator>());
+static_assert(BlockPageFits<GenericKey<4>, RID, GenericComparator<4>>());
+static_assert(BlockPageFits<GenericKey<8>, RID, GenericComparator<8>>());
+static_assert(BlockPageFits<GenericKey<16>, RID, GenericComparator<16>>());
+static_assert(BlockPageFits<GenericKey<32>, RID, GenericComparator<32>>());
+static_assert(BlockPageFits<GenericKey<64>, RID, GenericComparator<64>>());
+
 }  // namespace bustub
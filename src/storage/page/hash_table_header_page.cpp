@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstddef>
+
+#include "common/macros.h"
 #include "storage/page/hash_table_header_page.h"
 
 namespace bustub {
@@ -23,7 +26,11 @@ lsn_t HashTableHeaderPage::GetLSN() const { return lsn_; }
 
 void HashTableHeaderPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
-void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) { block_page_ids_[next_ind_++] = page_id; }
+void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {
+  BUSTUB_ASSERT(offsetof(HashTableHeaderPage, block_page_ids_) + (next_ind_ + 1) * sizeof(page_id_t) <= PAGE_SIZE,
+                "the block page ids must fit into the header page");
+  block_page_ids_[next_ind_++] = page_id;
+}
 
 size_t HashTableHeaderPage::NumBlocks() const { return next_ind_; }
 
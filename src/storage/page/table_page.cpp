@@ -264,7 +264,7 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
   }
 }
 
-bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager, bool zero_copy) {
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
   // If somehow we have more slots than tuples, abort the transaction.
@@ -293,14 +293,48 @@ bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
 
   // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  if (zero_copy) {
+    if (tuple->allocated_) {
+      delete[] tuple->data_;
+    }
+    tuple->data_ = GetData() + tuple_offset;
+    tuple->allocated_ = false;
+  } else {
+    // Reuse the buffer of the tuple if it has the right size, e.g. when scanning fixed-size tuples.
+    if (!tuple->allocated_ || tuple->size_ != tuple_size) {
+      if (tuple->allocated_) {
+        delete[] tuple->data_;
+      }
+      tuple->data_ = new char[tuple_size];
+      tuple->allocated_ = true;
+    }
+    memcpy(tuple->data_, GetData() + tuple_offset, tuple_size);
+  }
   tuple->size_ = tuple_size;
-  if (tuple->allocated_) {
-    delete[] tuple->data_;
+  tuple->rid_ = rid;
+  return true;
+}
+
+bool TablePage::ReadTupleOptimistic(const RID &rid, Tuple *tuple) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || SIZE_TABLE_PAGE_HEADER + SIZE_TUPLE * (slot_num + 1) > PAGE_SIZE) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  if (IsDeleted(tuple_size) || tuple_offset > PAGE_SIZE || tuple_size > PAGE_SIZE - tuple_offset) {
+    return false;
+  }
+  if (!tuple->allocated_ || tuple->size_ != tuple_size) {
+    if (tuple->allocated_) {
+      delete[] tuple->data_;
+    }
+    tuple->data_ = new char[tuple_size];
+    tuple->allocated_ = true;
   }
-  tuple->data_ = new char[tuple->size_];
-  memcpy(tuple->data_, GetData() + tuple_offset, tuple->size_);
+  memcpy(tuple->data_, GetData() + tuple_offset, tuple_size);
+  tuple->size_ = tuple_size;
   tuple->rid_ = rid;
-  tuple->allocated_ = true;
   return true;
 }
 
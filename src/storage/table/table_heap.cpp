@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>  // NOLINT
 
 #include "common/logger.h"
@@ -36,13 +37,13 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
-bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
+bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy) {
   if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(first_page_id_, strategy));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;  // NOLINT
@@ -59,11 +60,13 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
       // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(next_page_id, strategy));
       cur_page->WLatch();
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      // Place the new page close to its predecessor on disk, so that scans of the table stay sequential.
+      auto new_page = static_cast<TablePage *>(
+          buffer_pool_manager_->NewPageWithStrategy(&next_page_id, strategy, cur_page->GetTablePageId()));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -153,14 +156,25 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, BufferAccessStrategy *strategy) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(rid.GetPageId(), strategy));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  // Without tuple locks a read needs no latch: copy the tuple optimistically and validate the page version.
+  if (!enable_logging) {
+    for (int attempt = 0; attempt < OPTIMISTIC_READ_ATTEMPTS; attempt++) {
+      const uint64_t version = page->BeginOptimisticRead();
+      const bool res = page->ReadTupleOptimistic(rid, tuple);
+      if (page->ValidateRead(version)) {
+        buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+        return res;
+      }
+    }
+  }
   // Read the tuple from the page.
   page->RLatch();
   bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
@@ -169,16 +183,37 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   // Start an iterator from the first page.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(first_page_id_, strategy));
   page->RLatch();
   RID rid;
   // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
   page->GetFirstTupleRid(&rid);
+  const page_id_t next_page_id = page->GetNextPageId();
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, false);
-  return TableIterator(this, rid, txn);
+  TableIterator itr(this, rid, txn, strategy);
+  ReadAhead(first_page_id_, next_page_id, &itr.read_ahead_end_, strategy);
+  return itr;
+}
+
+void TableHeap::ReadAhead(page_id_t page_id, page_id_t next_page_id, page_id_t *read_ahead_end,
+                          BufferAccessStrategy *strategy) {
+  if (table_read_ahead_pages == 0 || next_page_id == INVALID_PAGE_ID || strategy != nullptr) {
+    return;
+  }
+  if (next_page_id != page_id + 1) {
+    buffer_pool_manager_->Prefetch(next_page_id);
+    *read_ahead_end = next_page_id + 1;
+    return;
+  }
+  const page_id_t first = std::max(next_page_id, *read_ahead_end);
+  const auto end = static_cast<page_id_t>(next_page_id + table_read_ahead_pages);
+  if (first < end) {
+    buffer_pool_manager_->PrefetchRange(first, end - first);
+    *read_ahead_end = end;
+  }
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_page_iterator.cpp
+//
+// Identification: src/storage/table/table_page_iterator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_page_iterator.h"
+
+#include <cassert>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+TablePageIterator::TablePageIterator(TableHeap *table_heap, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), txn_(txn), strategy_(strategy) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  page_ = static_cast<TablePage *>(buffer_pool_manager->FetchPageWithStrategy(table_heap_->first_page_id_, strategy_));
+  assert(page_ != nullptr);
+  page_->RLatch();
+  table_heap_->ReadAhead(page_->GetTablePageId(), page_->GetNextPageId(), &read_ahead_end_, strategy_);
+  if (!page_->GetFirstTupleRid(&rid_)) {
+    NextPage();
+  }
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+  }
+}
+
+TablePageIterator::~TablePageIterator() {
+  if (page_ != nullptr) {
+    table_heap_->buffer_pool_manager_->UnpinPage(page_->GetTablePageId(), false);
+  }
+}
+
+bool TablePageIterator::Next(Tuple *tuple, bool zero_copy) {
+  if (page_ == nullptr) {
+    return false;
+  }
+  page_->RLatch();
+  while (true) {
+    if (consumed_) {
+      RID next_rid;
+      if (page_->GetNextTupleRid(rid_, &next_rid)) {
+        rid_ = next_rid;
+      } else {
+        NextPage();
+        if (page_ == nullptr) {
+          return false;
+        }
+      }
+    }
+    consumed_ = true;
+    // Slots of tuples marked as deleted are still in use, skip them.
+    if (page_->GetTuple(rid_, tuple, txn_, table_heap_->lock_manager_, zero_copy)) {
+      break;
+    }
+  }
+  page_->RUnlatch();
+  return true;
+}
+
+void TablePageIterator::NextPage() {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  while (true) {
+    const page_id_t next_page_id = page_->GetNextPageId();
+    page_->RUnlatch();
+    buffer_pool_manager->UnpinPage(page_->GetTablePageId(), false);
+    if (next_page_id == INVALID_PAGE_ID) {
+      page_ = nullptr;
+      rid_ = RID(INVALID_PAGE_ID, 0);
+      return;
+    }
+    page_ = static_cast<TablePage *>(buffer_pool_manager->FetchPageWithStrategy(next_page_id, strategy_));
+    assert(page_ != nullptr);
+    page_->RLatch();
+    table_heap_->ReadAhead(next_page_id, page_->GetNextPageId(), &read_ahead_end_, strategy_);
+    if (page_->GetFirstTupleRid(&rid_)) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
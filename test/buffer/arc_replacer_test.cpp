@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <iostream>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+#include "replacer_trace.h"
+
+namespace bustub {
+
+/** Load the page into the frame and reference it once, the way the buffer pool manager does on a miss. */
+static void LoadAndUnpin(ArcReplacer *replacer, frame_id_t frame_id, page_id_t page_id) {
+  replacer->Load(frame_id, page_id);
+  replacer->Pin(frame_id);
+  replacer->Unpin(frame_id);
+}
+
+// NOLINTNEXTLINE
+TEST(ArcReplacerTest, SampleTest) {
+  ArcReplacer arc_replacer(4, 0);
+
+  // Scenario: load four pages, and reference pages 0 and 1 again. They move to T2.
+  for (frame_id_t frame_id = 0; frame_id < 4; ++frame_id) {
+    LoadAndUnpin(&arc_replacer, frame_id, frame_id + 100);
+  }
+  arc_replacer.Pin(0);
+  arc_replacer.Unpin(0);
+  arc_replacer.Pin(1);
+  arc_replacer.Unpin(1);
+  EXPECT_EQ(4, arc_replacer.Size());
+
+  // Scenario: T1 is above its target size 0, so the pages referenced once go first, LRU first.
+  int value;
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  LoadAndUnpin(&arc_replacer, 2, 200);
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  LoadAndUnpin(&arc_replacer, 3, 201);
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+
+  // Scenario: page 102 comes back while it is a ghost in B1, so T1 grows and the page goes to T2.
+  EXPECT_EQ(0, arc_replacer.GetTargetT1Size());
+  LoadAndUnpin(&arc_replacer, 2, 102);
+  EXPECT_EQ(1, arc_replacer.GetTargetT1Size());
+
+  // Scenario: T1 only holds 201 and is not above its target any more, so the LRU frame of T2 goes.
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 100 comes back from B2, so T1 shrinks again.
+  LoadAndUnpin(&arc_replacer, 0, 100);
+  EXPECT_EQ(0, arc_replacer.GetTargetT1Size());
+
+  // Scenario: pinned frames are skipped, removed frames are gone without a ghost.
+  arc_replacer.Pin(3);
+  arc_replacer.Remove(1);
+  EXPECT_EQ(2, arc_replacer.Size());
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+}
+
+// NOLINTNEXTLINE
+TEST(ArcReplacerTest, CorrelatedReferenceTest) {
+  ArcReplacer arc_replacer(2, 2);
+
+  // Scenario: page 100 is fetched once per tuple, page 101 is referenced again after a while.
+  arc_replacer.Load(0, 100);
+  arc_replacer.Pin(0);
+  for (int i = 0; i < 3; ++i) {
+    arc_replacer.Unpin(0);
+    arc_replacer.Pin(0);
+  }
+  arc_replacer.Unpin(0);
+  LoadAndUnpin(&arc_replacer, 1, 101);
+  arc_replacer.Pin(1);
+  arc_replacer.Unpin(1);
+
+  // Scenario: the correlated references left 100 in T1, so it is evicted before 101.
+  int value;
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+}
+
+// NOLINTNEXTLINE
+TEST(ArcReplacerTest, ReinstateTest) {
+  ArcReplacer arc_replacer(2, 0);
+  LoadAndUnpin(&arc_replacer, 0, 100);
+  LoadAndUnpin(&arc_replacer, 1, 101);
+
+  // Scenario: a hit pins the victim before the buffer pool claims it. Its page stays resident and is no ghost.
+  int value;
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  arc_replacer.Pin(0);
+  arc_replacer.Reinstate(0);
+  arc_replacer.Unpin(0);
+  EXPECT_EQ(2, arc_replacer.Size());
+
+  // Scenario: the re-reference moved page 100 to T2, so page 101 goes first. Once frame 1 is loaded again, page 101
+  // is a ghost: it comes back into T2 and grows T1.
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  LoadAndUnpin(&arc_replacer, 1, 102);
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  LoadAndUnpin(&arc_replacer, 1, 101);
+  EXPECT_EQ(1, arc_replacer.GetTargetT1Size());
+
+  // Scenario: a reinstated victim is found again by the next victim search.
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  arc_replacer.Reinstate(value);
+  arc_replacer.Unpin(value);
+  frame_id_t again;
+  EXPECT_TRUE(arc_replacer.Victim(&again));
+  EXPECT_EQ(value, again);
+}
+
+// NOLINTNEXTLINE
+TEST(ArcReplacerTest, PinnedFramesTest) {
+  ArcReplacer arc_replacer(4, 0);
+  LoadAndUnpin(&arc_replacer, 0, 100);
+  arc_replacer.Pin(0);
+  arc_replacer.Unpin(0);
+
+  // Scenario: pinned frames are in no list, but still count for the size of T1, so T1 stays the list victims are
+  // taken from.
+  for (frame_id_t frame_id = 1; frame_id < 4; ++frame_id) {
+    arc_replacer.Load(frame_id, frame_id + 100);
+    arc_replacer.Pin(frame_id);
+  }
+  EXPECT_EQ(1, arc_replacer.Size());
+  arc_replacer.Unpin(3);
+  int value;
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+
+  // Scenario: an unpinned frame becomes the MRU frame of its list.
+  arc_replacer.Unpin(2);
+  arc_replacer.Unpin(1);
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+}
+
+// NOLINTNEXTLINE
+TEST(ArcReplacerTest, ScanResistanceTest) {
+  const size_t num_hot_pages = 256;
+  const size_t num_scan_pages = 512;
+  const auto trace = ScanPollutedZipfTrace(num_hot_pages, num_scan_pages, 20000);
+
+  // Scenario: the scans flush the hot pages out of a CLOCK pool, ARC keeps them in T2.
+  const double clock_hit_ratio =
+      ReplayTrace(BufferPoolManager::ReplacerType::CLOCK, 64, trace, num_hot_pages + num_scan_pages);
+  const double arc_hit_ratio =
+      ReplayTrace(BufferPoolManager::ReplacerType::ARC, 64, trace, num_hot_pages + num_scan_pages);
+  EXPECT_LT(clock_hit_ratio, arc_hit_ratio);
+}
+
+// Hit ratio of CLOCK, LRU-K and ARC on a scan-polluted Zipfian trace, for several pool sizes.
+// NOLINTNEXTLINE
+TEST(ArcReplacerTest, DISABLED_HitRatioBenchmark) {
+  const size_t num_hot_pages = 1024;
+  const size_t num_scan_pages = 2048;
+  const auto trace = ScanPollutedZipfTrace(num_hot_pages, num_scan_pages, 50000);
+
+  for (size_t buffer_pool_size : {32, 128, 512}) {
+    std::cout << "pool size: " << buffer_pool_size;
+    for (auto replacer_type : {BufferPoolManager::ReplacerType::CLOCK, BufferPoolManager::ReplacerType::LRU_K,
+                               BufferPoolManager::ReplacerType::ARC}) {
+      std::cout << " " << (replacer_type == BufferPoolManager::ReplacerType::CLOCK
+                               ? "clock"
+                               : replacer_type == BufferPoolManager::ReplacerType::LRU_K ? "lru-k" : "arc")
+                << " hit ratio: " << ReplayTrace(replacer_type, buffer_pool_size, trace, num_hot_pages + num_scan_pages);
+    }
+    std::cout << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy_test.cpp
+//
+// Identification: test/buffer/buffer_access_strategy_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferAccessStrategyTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_hot_pages = 32;
+  const size_t num_scan_pages = 256;
+
+  for (size_t num_shards : {1, 4}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < num_hot_pages + num_scan_pages; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Page %zu", i);
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+    auto fetch_hot_pages = [bpm]() {
+      for (page_id_t i = 0; i < static_cast<page_id_t>(num_hot_pages); ++i) {
+        ASSERT_NE(nullptr, bpm->FetchPage(i));
+        EXPECT_TRUE(bpm->UnpinPage(i, false));
+      }
+    };
+    auto scan = [bpm](BufferAccessStrategy *strategy) {
+      for (page_id_t i = num_hot_pages; i < static_cast<page_id_t>(num_hot_pages + num_scan_pages); ++i) {
+        auto *page = bpm->FetchPageWithStrategy(i, strategy);
+        ASSERT_NE(nullptr, page);
+        char expected[PAGE_SIZE];
+        snprintf(expected, PAGE_SIZE, "Page %d", i);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_TRUE(bpm->UnpinPage(i, false));
+      }
+    };
+    auto num_hot_pages_resident = [bpm]() {
+      size_t num_resident = 0;
+      for (page_id_t i = 0; i < static_cast<page_id_t>(num_hot_pages); ++i) {
+        num_resident += bpm->FindInBuffer(i) ? 1 : 0;
+      }
+      return num_resident;
+    };
+
+    // Scenario: the ring is capped at 1/8 of the pool.
+    BufferAccessStrategy strategy(bpm, BULK_ACCESS_RING_SIZE);
+    EXPECT_EQ(buffer_pool_size / 8, strategy.GetRingSize());
+
+    // Scenario: a scan through a ring leaves the hot pages alone.
+    fetch_hot_pages();
+    EXPECT_EQ(num_hot_pages, num_hot_pages_resident());
+    scan(&strategy);
+    EXPECT_EQ(num_hot_pages, num_hot_pages_resident());
+
+    // Scenario: a normal scan flushes them out.
+    fetch_hot_pages();
+    scan(nullptr);
+    EXPECT_EQ(0, num_hot_pages_resident());
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
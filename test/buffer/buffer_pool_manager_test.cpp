@@ -11,7 +11,10 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdio>
+#include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -711,7 +714,7 @@ TEST(BufferPoolManagerTest, DeletePage) {
 
   page = bpm->NewPage(&page_id_temp);
   ASSERT_NE(nullptr, page);
-  EXPECT_EQ(20, page_id_temp);  // Added by Jigao
+  EXPECT_EQ(4, page_id_temp);  // The page id of the deleted page is reused
   EXPECT_EQ(0, bpm->GetReplacerSize());  // Added by Jigao, GetReplacerSize is a function for test
   EXPECT_EQ(0, bpm->GetFreeListSize());  // Added by Jigao, GetReplacerSize is a function for test
 
@@ -760,7 +763,7 @@ TEST(BufferPoolManagerTest, DeletePage) {
 
   page = bpm->NewPage(&page_id_temp);
   ASSERT_NE(nullptr, page);
-  EXPECT_EQ(21, page_id_temp);  // Added by Jigao
+  EXPECT_EQ(7, page_id_temp);  // The page id of the deleted page is reused
   EXPECT_EQ(2, bpm->GetReplacerSize());  // Added by Jigao, GetReplacerSize is a function for test
   EXPECT_EQ(0, bpm->GetFreeListSize());  // Added by Jigao, GetReplacerSize is a function for test
 
@@ -879,4 +882,63 @@ TEST(BufferPoolManagerTest, IsDirty) {
   delete bpm;
   delete disk_manager;
 }
+
+// Hits and unpins run under the shared latch and race with each other and with evictions.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentHitTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 24;
+  const int num_threads = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  bpm->FlushAllPages();
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid]() {
+      std::mt19937 gen(tid);
+      // Most accesses hit the first half of the pages, the rest forces evictions.
+      std::uniform_int_distribution<page_id_t> hot(0, buffer_pool_size / 2 - 1);
+      std::uniform_int_distribution<page_id_t> all(0, num_pages - 1);
+      for (int i = 0; i < 5000; ++i) {
+        const page_id_t page_id = i % 10 == 0 ? all(gen) : hot(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->RLatch();
+        EXPECT_EQ(page_id, std::stoi(page->GetData()));
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every frame is unpinned again, so every frame has to be evictable.
+  EXPECT_EQ(buffer_pool_size, bpm->GetReplacerSize() + bpm->GetFreeListSize());
+  for (int i = 0; i < num_pages; ++i) {
+    if (bpm->FindInBuffer(i)) {
+      EXPECT_EQ(0, bpm->GetPagePinCount(i));
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
 }  // namespace bustub
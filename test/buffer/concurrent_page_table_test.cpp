@@ -0,0 +1,172 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table_test.cpp
+//
+// Identification: test/buffer/concurrent_page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <shared_mutex>  // NOLINT
+#include <thread>        // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/concurrent_page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ConcurrentPageTableTest, SampleTest) {
+  ConcurrentPageTable page_table(8);
+  frame_id_t frame_id;
+
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  for (page_id_t i = 0; i < 8; i++) {
+    page_table.Insert(i, i + 100);
+    EXPECT_EQ(i + 1, page_table.Size());
+  }
+  for (page_id_t i = 0; i < 8; i++) {
+    EXPECT_TRUE(page_table.Find(i, &frame_id));
+    EXPECT_EQ(i + 100, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(8, &frame_id));
+
+  // Scenario: inserting an existing page overwrites its frame.
+  page_table.Insert(3, 42);
+  EXPECT_EQ(8, page_table.Size());
+  EXPECT_TRUE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(42, frame_id);
+
+  // Scenario: erased pages are gone, the others are still found behind the tombstones.
+  EXPECT_TRUE(page_table.Erase(3));
+  EXPECT_FALSE(page_table.Erase(3));
+  EXPECT_FALSE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(7, page_table.Size());
+  for (page_id_t i = 0; i < 8; i++) {
+    if (i != 3) {
+      EXPECT_TRUE(page_table.Find(i, &frame_id));
+      EXPECT_EQ(i + 100, frame_id);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ConcurrentPageTableTest, ChurnTest) {
+  // Buffer pool like churn: the table never holds more than num_frames pages, but tombstones keep piling up and
+  // force rebuilds of the slot array.
+  constexpr size_t num_frames = 16;
+  ConcurrentPageTable page_table(num_frames);
+  frame_id_t frame_id;
+  for (page_id_t i = 0; i < 10000; i++) {
+    if (i >= static_cast<page_id_t>(num_frames)) {
+      EXPECT_TRUE(page_table.Erase(i - num_frames));
+    }
+    page_table.Insert(i, i % num_frames);
+    EXPECT_LE(page_table.Size(), num_frames);
+  }
+  EXPECT_EQ(num_frames, page_table.Size());
+  for (page_id_t i = 0; i < 10000; i++) {
+    EXPECT_EQ(i >= 10000 - static_cast<page_id_t>(num_frames), page_table.Find(i, &frame_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ConcurrentPageTableTest, ConcurrentReadersTest) {
+  // One writer keeps moving a window of pages through the table, rebuilding it every now and then, while readers
+  // look them up lock-free. Pages that are found always map to their frame.
+  constexpr size_t num_frames = 32;
+  constexpr int num_readers = 4;
+  ConcurrentPageTable page_table(num_frames);
+  std::atomic<page_id_t> window_start{0};
+  std::atomic<bool> done{false};
+  for (page_id_t i = 0; i < static_cast<page_id_t>(num_frames); i++) {
+    page_table.Insert(i, i % num_frames);
+  }
+
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&page_table, &window_start, &done, tid]() {
+      std::mt19937 gen(tid);
+      while (!done) {
+        const page_id_t start = window_start;
+        const page_id_t page_id = start + static_cast<page_id_t>(gen() % (2 * num_frames));
+        frame_id_t frame_id;
+        if (page_table.Find(page_id, &frame_id)) {
+          EXPECT_EQ(page_id % static_cast<page_id_t>(num_frames), frame_id);
+        }
+      }
+    });
+  }
+  for (page_id_t i = num_frames; i < 20000; i++) {
+    page_table.Erase(i - num_frames);
+    window_start = i - num_frames + 1;
+    page_table.Insert(i, i % num_frames);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_frames, page_table.Size());
+}
+
+// Lookup latency of the lock-free page table against the std::unordered_map behind a shared latch it replaces.
+// NOLINTNEXTLINE
+TEST(ConcurrentPageTableTest, DISABLED_LookupBenchmark) {
+  constexpr size_t num_frames = 1024;
+  constexpr int lookups_per_thread = 20000;
+
+  std::unordered_map<page_id_t, frame_id_t> map;
+  std::shared_mutex map_latch;
+  ConcurrentPageTable page_table(num_frames);
+  for (page_id_t i = 0; i < static_cast<page_id_t>(num_frames); i++) {
+    map.emplace(i, i);
+    page_table.Insert(i, i);
+  }
+
+  auto run = [](int num_threads, auto &&lookup) {
+    std::atomic<int64_t> found{0};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&lookup, &found, tid]() {
+        std::mt19937 gen(tid);
+        int64_t local_found = 0;
+        for (int i = 0; i < lookups_per_thread; i++) {
+          // Half of the lookups miss.
+          local_found += lookup(static_cast<page_id_t>(gen() % (2 * num_frames))) ? 1 : 0;
+        }
+        found += local_found;
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_LT(0, found.load());
+    return elapsed.count() / (static_cast<double>(num_threads) * lookups_per_thread);
+  };
+
+  for (int num_threads : {1, 4, 16, 64}) {
+    const double map_ns = run(num_threads, [&map, &map_latch](page_id_t page_id) {
+      std::shared_lock<std::shared_mutex> lock(map_latch);
+      return map.find(page_id) != map.end();
+    });
+    const double table_ns = run(num_threads, [&page_table](page_id_t page_id) {
+      frame_id_t frame_id;
+      return page_table.Find(page_id, &frame_id);
+    });
+    std::cout << "threads: " << num_threads << " unordered_map+latch ns/lookup: " << map_ns
+              << " concurrent page table ns/lookup: " << table_ns << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// fetch_pages_test.cpp
+//
+// Identification: test/buffer/fetch_pages_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "page_fixture.h"
+
+namespace bustub {
+
+/** Check the content of every fetched page and unpin it. */
+static void CheckAndUnpin(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids,
+                          const std::vector<Page *> &pages) {
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_TRUE(HasPageContent(pages[i]->GetData(), page_ids[i]));
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FetchPagesTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+
+  for (bool direct_io : {false, true}) {
+    for (size_t num_shards : {1, 4}) {
+      auto *disk_manager = new DiskManager(db_name, direct_io);
+      auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+      CreatePages(bpm, num_pages);
+
+      // Scenario: unsorted misses, runs of consecutive pages and a resident page in one batch.
+      auto *resident = bpm->FetchPage(63);
+      ASSERT_NE(nullptr, resident);
+      std::vector<page_id_t> page_ids{9, 2, 3, 4, 63, 40, 5};
+      std::vector<Page *> pages(page_ids.size());
+      EXPECT_TRUE(bpm->FetchPages(page_ids, pages.data()));
+      EXPECT_EQ(2, bpm->GetPagePinCount(63));
+      CheckAndUnpin(bpm, page_ids, pages);
+      EXPECT_TRUE(bpm->UnpinPage(63, false));
+
+      // Scenario: a page listed twice is pinned twice.
+      page_ids = {20, 21, 20};
+      pages.assign(page_ids.size(), nullptr);
+      EXPECT_TRUE(bpm->FetchPages(page_ids, pages.data()));
+      EXPECT_EQ(pages[0], pages[2]);
+      EXPECT_EQ(2, bpm->GetPagePinCount(20));
+      CheckAndUnpin(bpm, page_ids, pages);
+      EXPECT_EQ(0, bpm->GetPagePinCount(20));
+
+      // Scenario: more pages than frames. The batch fails as a whole and leaves no page pinned.
+      page_ids.clear();
+      for (page_id_t i = 0; i < static_cast<page_id_t>(num_pages); i += 2) {
+        page_ids.push_back(i);
+      }
+      pages.assign(page_ids.size(), nullptr);
+      EXPECT_FALSE(bpm->FetchPages(page_ids, pages.data()));
+      for (size_t i = 0; i < page_ids.size(); ++i) {
+        EXPECT_EQ(nullptr, pages[i]);
+        if (bpm->FindInBuffer(page_ids[i])) {
+          EXPECT_EQ(0, bpm->GetPagePinCount(page_ids[i]));
+        }
+      }
+
+      // Scenario: dirty victims are written back before their frames are reused by a batch.
+      for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+        auto *page = bpm->FetchPage(i);
+        ASSERT_NE(nullptr, page);
+        WritePageContent(page->GetData(), i);
+        EXPECT_TRUE(bpm->UnpinPage(i, true));
+      }
+      page_ids = {48, 49, 50, 51, 52, 53, 54, 55};
+      pages.assign(page_ids.size(), nullptr);
+      EXPECT_TRUE(bpm->FetchPages(page_ids, pages.data()));
+      CheckAndUnpin(bpm, page_ids, pages);
+      page_ids = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+      pages.assign(page_ids.size(), nullptr);
+      EXPECT_TRUE(bpm->FetchPages(page_ids, pages.data()));
+      CheckAndUnpin(bpm, page_ids, pages);
+
+      disk_manager->ShutDown();
+      remove("test.db");
+      delete bpm;
+      delete disk_manager;
+    }
+  }
+}
+
+// Cold random probes of a few pages each, as issued by a hash join, fetched one by one and as a batch. Prints the
+// throughput of each.
+// NOLINTNEXTLINE
+TEST(FetchPagesTest, DISABLED_ColdProbeBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_pages = 1024;
+  const size_t batch_size = 8;
+  const int num_batches = 2000;
+
+  for (bool direct_io : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name, direct_io);
+    {
+      BufferPoolManager bpm(num_pages, disk_manager);
+      CreatePages(&bpm, num_pages);
+    }
+    for (bool batched : {false, true}) {
+      BufferPoolManager bpm(buffer_pool_size, disk_manager);
+      std::mt19937 gen(0);
+      std::vector<page_id_t> page_ids(batch_size);
+      std::vector<Page *> pages(batch_size);
+      const auto start = std::chrono::steady_clock::now();
+      for (int batch = 0; batch < num_batches; ++batch) {
+        // Half of the probes land on a run of neighbouring pages.
+        const auto run_start = static_cast<page_id_t>(gen() % (num_pages - batch_size / 2));
+        for (size_t i = 0; i < batch_size; ++i) {
+          page_ids[i] = i < batch_size / 2 ? run_start + static_cast<page_id_t>(i)
+                                           : static_cast<page_id_t>(gen() % num_pages);
+        }
+        if (batched) {
+          bpm.FetchPages(page_ids, pages.data());
+        } else {
+          for (size_t i = 0; i < batch_size; ++i) {
+            pages[i] = bpm.FetchPage(page_ids[i]);
+          }
+        }
+        for (size_t i = 0; i < batch_size; ++i) {
+          ASSERT_NE(nullptr, pages[i]);
+          EXPECT_TRUE(bpm.UnpinPage(page_ids[i], false));
+        }
+      }
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "direct I/O: " << disk_manager->IsDirectIO() << " batched: " << batched
+                << " page fetches/s: " << static_cast<int64_t>(num_batches * batch_size / elapsed.count())
+                << std::endl;
+    }
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
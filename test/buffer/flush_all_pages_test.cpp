@@ -0,0 +1,277 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// flush_all_pages_test.cpp
+//
+// Identification: test/buffer/flush_all_pages_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** The content of the test pages starts behind the page header, which holds the LSN. */
+static constexpr size_t CONTENT_OFFSET = 8;
+
+/** @return the update count stored in a page */
+static int ReadCount(const char *data) {
+  int count;
+  memcpy(&count, data + CONTENT_OFFSET, sizeof(count));
+  return count;
+}
+
+// NOLINTNEXTLINE
+TEST(FlushAllPagesTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 64;
+
+  for (size_t num_shards : {1, 4}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(num_pages, disk_manager, nullptr, num_shards);
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      memcpy(page->GetData() + CONTENT_OFFSET, &i, sizeof(i));
+      // Every fourth page stays pinned and write latched by another user.
+      if (i % 4 != 0) {
+        EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+      }
+    }
+
+    // Scenario: every dirty page is written once, pages latched by other users after the others, and the file is
+    // synced once.
+    std::thread holder([bpm] {
+      for (page_id_t page_id = 0; page_id < num_pages; page_id += 4) {
+        auto *page = bpm->FetchPage(page_id);
+        page->WLatch();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      for (page_id_t page_id = 0; page_id < num_pages; page_id += 4) {
+        auto *page = bpm->FetchPage(page_id);
+        page->WUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    const int num_writes = disk_manager->GetNumWrites();
+    bpm->FlushAllPages();
+    EXPECT_EQ(num_writes + num_pages, disk_manager->GetNumWrites());
+    EXPECT_EQ(1, disk_manager->GetNumSyncs());
+    holder.join();
+    char data[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      disk_manager->ReadPage(page_id, data);
+      EXPECT_EQ(page_id, ReadCount(data));
+    }
+
+    // Scenario: only the pages dirtied since are written by the next flush.
+    for (page_id_t page_id = 0; page_id < num_pages; page_id += 2) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, page_id % 4 == 0));
+    }
+    bpm->FlushAllPages();
+    EXPECT_EQ(num_writes + num_pages + num_pages / 4, disk_manager->GetNumWrites());
+    EXPECT_EQ(2, disk_manager->GetNumSyncs());
+
+    disk_manager->ShutDown();
+    remove(db_name.c_str());
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FlushAllPagesTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const int num_threads = 4;
+  const int num_pages = 256;
+  const int num_updates = 5000;
+
+  for (size_t num_shards : {1, 4}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(64, disk_manager, nullptr, num_shards);
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+
+    // Every thread counts the updates of its own pages, under the page write latch, while the pool is flushed
+    // over and over. An update lost by a flush or an eviction racing with it breaks the count.
+    std::atomic<bool> done{false};
+    std::thread flusher([bpm, &done] {
+      while (!done) {
+        bpm->FlushAllPages();
+      }
+    });
+    std::vector<std::thread> threads;
+    std::vector<std::vector<int>> counts(num_threads, std::vector<int>(num_pages / num_threads, 0));
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([bpm, tid, &counts] {
+        std::mt19937 gen(tid);
+        auto &thread_counts = counts[tid];
+        for (int i = 0; i < num_updates; ++i) {
+          const auto slot = static_cast<int>(gen() % thread_counts.size());
+          const page_id_t page_id = slot * num_threads + tid;
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          page->WLatch();
+          EXPECT_EQ(thread_counts[slot], ReadCount(page->GetData()));
+          thread_counts[slot]++;
+          memcpy(page->GetData() + CONTENT_OFFSET, &thread_counts[slot], sizeof(int));
+          page->WUnlatch();
+          EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    done = true;
+    flusher.join();
+
+    // Scenario: after a last flush, the disk holds every update.
+    bpm->FlushAllPages();
+    char data[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      disk_manager->ReadPage(page_id, data);
+      EXPECT_EQ(counts[page_id % num_threads][page_id / num_threads], ReadCount(data));
+    }
+
+    disk_manager->ShutDown();
+    remove(db_name.c_str());
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FlushAllPagesTest, LatchedVictimTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(2, disk_manager);
+  page_id_t page_id_temp;
+  Page *pages[2];
+  for (auto &page : pages) {
+    page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: both pages are unpinned, page 0 is read latched the way FlushAllPages latches the pages it writes. A
+  // miss evicts page 1 instead of waiting for the latch.
+  pages[0]->RLatch();
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(2, page_id_temp);
+  EXPECT_TRUE(bpm->FindInBuffer(0));
+  EXPECT_FALSE(bpm->FindInBuffer(1));
+
+  // Scenario: only the latched page can be evicted, so the miss waits for its latch.
+  std::thread holder([&pages] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pages[0]->RUnlatch();
+  });
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_FALSE(bpm->FindInBuffer(0));
+  holder.join();
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  EXPECT_TRUE(bpm->UnpinPage(2, false));
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+// A checkpoint of a pool full of dirty pages, which were dirtied in random order, with direct I/O. Prints the time of
+// writing them one page at a time in that order, the way a flush in frame order does, and of FlushAllPages. Also
+// prints the worst latency of fetches running during FlushAllPages.
+// NOLINTNEXTLINE
+TEST(FlushAllPagesTest, DISABLED_FlushAllPagesBenchmark) {
+  const std::string db_name = "test.db";
+  const int num_pages = 4096;
+
+  auto *disk_manager = new DiskManager(db_name, true);
+  auto *bpm = new BufferPoolManager(num_pages, disk_manager, nullptr, 4);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  std::vector<page_id_t> page_ids(num_pages);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    page_ids[page_id] = page_id;
+  }
+  std::shuffle(page_ids.begin(), page_ids.end(), std::mt19937(0));
+
+  // One write per page in random order, then a sync.
+  std::vector<Page *> pages;
+  for (const page_id_t page_id : page_ids) {
+    pages.push_back(bpm->FetchPage(page_id));
+    pages.back()->GetData()[CONTENT_OFFSET]++;
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    disk_manager->WritePage(page_ids[i], pages[i]->GetData());
+  }
+  disk_manager->SyncDataFile();
+  const std::chrono::duration<double, std::milli> per_page_elapsed = std::chrono::steady_clock::now() - start;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+
+  std::atomic<bool> done{false};
+  std::chrono::duration<double, std::micro> max_fetch_latency{0};
+  std::thread reader([bpm, &done, &max_fetch_latency] {
+    std::mt19937 gen(1);
+    while (!done) {
+      const auto page_id = static_cast<page_id_t>(gen() % num_pages);
+      const auto fetch_start = std::chrono::steady_clock::now();
+      auto *page = bpm->FetchPage(page_id);
+      max_fetch_latency = std::max(max_fetch_latency, std::chrono::duration<double, std::micro>(
+                                                          std::chrono::steady_clock::now() - fetch_start));
+      if (page != nullptr) {
+        bpm->UnpinPage(page_id, false);
+      }
+    }
+  });
+  start = std::chrono::steady_clock::now();
+  bpm->FlushAllPages();
+  const std::chrono::duration<double, std::milli> flush_elapsed = std::chrono::steady_clock::now() - start;
+  done = true;
+  reader.join();
+
+  std::cout << "dirty pages: " << num_pages << " per-page writes ms: " << per_page_elapsed.count()
+            << " FlushAllPages ms: " << flush_elapsed.count()
+            << " max fetch latency during flush us: " << max_fetch_latency.count() << std::endl;
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
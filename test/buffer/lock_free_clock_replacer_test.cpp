@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lock_free_clock_replacer_test.cpp
+//
+// Identification: test/buffer/lock_free_clock_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lock_free_clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LockFreeClockReplacerTest, SampleTest) {
+  LockFreeClockReplacer clock_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer.
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(2);
+  clock_replacer.Unpin(3);
+  clock_replacer.Unpin(4);
+  clock_replacer.Unpin(5);
+  clock_replacer.Unpin(6);
+  clock_replacer.Unpin(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // Scenario: get three victims from the clock.
+  int value;
+  EXPECT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  clock_replacer.Pin(3);
+  clock_replacer.Pin(4);
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
+  clock_replacer.Unpin(4);
+
+  // Scenario: continue looking for victims. We expect these victims.
+  EXPECT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  EXPECT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(LockFreeClockReplacerTest, ConcurrencyTest) {
+  // Frames span several bitmap words, so that threads share words with each other and with the evictor.
+  constexpr size_t num_pages = 100;
+  constexpr int num_threads = 4;
+  LockFreeClockReplacer clock_replacer(num_pages);
+  std::atomic<bool> done{false};
+  std::vector<int> num_victims(num_pages, 0);
+
+  // Every thread owns the frames f with f % num_threads == tid and keeps pinning and unpinning them, the evictor
+  // keeps taking victims. In the end every frame is either evicted or in the replacer, exactly once.
+  std::thread evictor([&clock_replacer, &done, &num_victims]() {
+    frame_id_t frame_id;
+    while (!done) {
+      if (clock_replacer.Victim(&frame_id)) {
+        num_victims[frame_id]++;
+      }
+    }
+  });
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&clock_replacer, tid]() {
+      for (int i = 0; i < 10000; i++) {
+        for (auto frame_id = static_cast<frame_id_t>(tid); frame_id < static_cast<frame_id_t>(num_pages);
+             frame_id += num_threads) {
+          clock_replacer.Pin(frame_id);
+          clock_replacer.Unpin(frame_id);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  evictor.join();
+
+  // The evictor may have taken a frame between its Unpin and the next Pin, so count what is left.
+  std::set<frame_id_t> remaining;
+  frame_id_t frame_id;
+  const size_t size = clock_replacer.Size();
+  while (clock_replacer.Victim(&frame_id)) {
+    EXPECT_TRUE(remaining.insert(frame_id).second);
+  }
+  EXPECT_EQ(size, remaining.size());
+  EXPECT_EQ(0, clock_replacer.Size());
+  for (frame_id_t i = 0; i < static_cast<frame_id_t>(num_pages); i++) {
+    // The last operation of every frame was an Unpin, so it was evicted at least once.
+    EXPECT_TRUE(num_victims[i] > 0 || remaining.count(i) == 1);
+  }
+}
+
+// Unpin/Pin throughput of many threads while an evictor keeps calling Victim, with the latched ClockReplacer and the
+// LockFreeClockReplacer. Prints the throughput of each setup.
+// NOLINTNEXTLINE
+TEST(LockFreeClockReplacerTest, DISABLED_ContentionBenchmark) {
+  constexpr size_t num_pages = 1024;
+  constexpr int ops_per_thread = 200000;
+
+  auto run = [](Replacer *replacer, int num_threads) {
+    std::atomic<bool> done{false};
+    std::atomic<int64_t> num_victims{0};
+    for (frame_id_t i = 0; i < static_cast<frame_id_t>(num_pages); i++) {
+      replacer->Unpin(i);
+    }
+    std::thread evictor([replacer, &done, &num_victims]() {
+      frame_id_t frame_id;
+      while (!done) {
+        if (replacer->Victim(&frame_id)) {
+          num_victims++;
+          replacer->Unpin(frame_id);
+        }
+      }
+    });
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([replacer, tid]() {
+        std::mt19937 gen(tid);
+        for (int i = 0; i < ops_per_thread; i++) {
+          const auto frame_id = static_cast<frame_id_t>(gen() % num_pages);
+          replacer->Pin(frame_id);
+          replacer->Unpin(frame_id);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    done = true;
+    evictor.join();
+    EXPECT_EQ(static_cast<size_t>(num_pages), replacer->Size());
+    return std::make_pair(num_threads * ops_per_thread / elapsed.count(), num_victims.load());
+  };
+
+  for (int num_threads : {1, 2, 4, 8, 16}) {
+    ClockReplacer clock_replacer(num_pages);
+    LockFreeClockReplacer lock_free_clock_replacer(num_pages);
+    const auto [latched_ops, latched_victims] = run(&clock_replacer, num_threads);
+    const auto [lock_free_ops, lock_free_victims] = run(&lock_free_clock_replacer, num_threads);
+    std::cout << "threads: " << num_threads << " clock pin+unpin/s: " << static_cast<int64_t>(latched_ops)
+              << " (victims: " << latched_victims << ") lock-free clock pin+unpin/s: "
+              << static_cast<int64_t>(lock_free_ops) << " (victims: " << lock_free_victims << ")" << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <iostream>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+#include "replacer_trace.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_replacer(7, 2, 0);
+
+  // Scenario: frames 1 and 2 are referenced twice, 3, 4 and 5 once.
+  for (frame_id_t frame_id : {1, 2, 3, 1, 4, 2, 5}) {
+    lru_replacer.Pin(frame_id);
+  }
+  for (frame_id_t frame_id = 1; frame_id <= 5; ++frame_id) {
+    lru_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(5, lru_replacer.Size());
+
+  // Scenario: frames with a single reference go first, in the order of their reference.
+  int value;
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: pinned frames are not evictable.
+  lru_replacer.Pin(5);
+  EXPECT_EQ(2, lru_replacer.Size());
+
+  // Scenario: 1 and 2 are ordered by their second most recent reference.
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(lru_replacer.Victim(&value));
+
+  // Scenario: 5 now has two references, a victimized frame starts over with an empty history once it gets a new page.
+  lru_replacer.Load(1, 10);
+  lru_replacer.Pin(1);
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(5);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+
+  // Scenario: a removed frame forgets its history.
+  lru_replacer.Pin(6);
+  lru_replacer.Pin(6);
+  lru_replacer.Unpin(6);
+  lru_replacer.Remove(6);
+  EXPECT_EQ(0, lru_replacer.Size());
+  lru_replacer.Pin(6);
+  lru_replacer.Pin(0);
+  lru_replacer.Pin(0);
+  lru_replacer.Unpin(0);
+  lru_replacer.Unpin(6);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+
+  // Scenario: a reinstated frame keeps its page and its history, it is not evicted ahead of frames with fewer
+  // references.
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  lru_replacer.Reinstate(0);
+  lru_replacer.Unpin(0);
+  lru_replacer.Load(6, 11);
+  lru_replacer.Pin(6);
+  lru_replacer.Unpin(6);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_replacer(4, 2, 2);
+
+  // Scenario: frame 0 is referenced three times in a row, like a scan reading tuple after tuple. That is a single
+  // correlated reference, while frame 1 has two uncorrelated references.
+  for (frame_id_t frame_id : {1, 0, 0, 0, 1, 2, 3}) {
+    lru_replacer.Pin(frame_id);
+  }
+  // Scenario: frame 3 is within the correlated period of its last reference and only evicted as the last resort.
+  for (frame_id_t frame_id : {0, 1, 3}) {
+    lru_replacer.Unpin(frame_id);
+  }
+  int value;
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const size_t num_hot_pages = 256;
+  const size_t num_scan_pages = 512;
+  const auto trace = ScanPollutedZipfTrace(num_hot_pages, num_scan_pages, 20000);
+
+  // Scenario: the scans flush the hot pages out of a CLOCK pool, LRU-K keeps them.
+  const double clock_hit_ratio =
+      ReplayTrace(BufferPoolManager::ReplacerType::CLOCK, 64, trace, num_hot_pages + num_scan_pages);
+  const double lru_k_hit_ratio =
+      ReplayTrace(BufferPoolManager::ReplacerType::LRU_K, 64, trace, num_hot_pages + num_scan_pages);
+  EXPECT_LT(clock_hit_ratio, lru_k_hit_ratio);
+}
+
+// Hit ratio of CLOCK against LRU-K on a scan-polluted Zipfian trace, for several pool sizes.
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, DISABLED_HitRatioBenchmark) {
+  const size_t num_hot_pages = 1024;
+  const size_t num_scan_pages = 2048;
+  const auto trace = ScanPollutedZipfTrace(num_hot_pages, num_scan_pages, 50000);
+
+  for (size_t buffer_pool_size : {32, 128, 512}) {
+    const double clock_hit_ratio =
+        ReplayTrace(BufferPoolManager::ReplacerType::CLOCK, buffer_pool_size, trace, num_hot_pages + num_scan_pages);
+    const double lru_k_hit_ratio =
+        ReplayTrace(BufferPoolManager::ReplacerType::LRU_K, buffer_pool_size, trace, num_hot_pages + num_scan_pages);
+    std::cout << "pool size: " << buffer_pool_size << " clock hit ratio: " << clock_hit_ratio
+              << " lru-k hit ratio: " << lru_k_hit_ratio << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_cleaner_test.cpp
+//
+// Identification: test/buffer/page_cleaner_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+
+namespace bustub {
+
+/** Poll until the page cleaner wrote back num_writes pages, or give up after a second. */
+static void WaitForCleanerWrites(BufferPoolManager *bpm, size_t num_writes) {
+  for (int i = 0; i < 100 && bpm->GetNumCleanerWrites() < num_writes; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageCleanerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %zu", i);
+  }
+  // Scenario: pinned pages are left alone.
+  bpm->RunPageCleaner(1.0);
+  std::this_thread::sleep_for(page_cleaner_interval * 5);
+  EXPECT_EQ(0, bpm->GetNumCleanerWrites());
+
+  // Scenario: once unpinned, every dirty page is written back in the background.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  WaitForCleanerWrites(bpm, buffer_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumCleanerWrites());
+  bpm->StopPageCleaner();
+
+  // Scenario: evicting the cleaned pages needs no foreground write, and their content made it to disk.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumEvictions());
+  EXPECT_EQ(0, bpm->GetNumForegroundWrites());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "Page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageCleanerTest, WALTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, log_manager, 2);
+  enable_logging = true;
+
+  page_id_t page_id_temp;
+  for (lsn_t i = 0; i < static_cast<lsn_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    page->SetLSN(i);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: nothing is persistent in the log yet, so no page may be written.
+  bpm->RunPageCleaner(1.0);
+  std::this_thread::sleep_for(page_cleaner_interval * 5);
+  EXPECT_EQ(0, bpm->GetNumCleanerWrites());
+
+  // Scenario: pages are written as soon as their log records are persistent.
+  log_manager->SetPersistentLSN(1);
+  WaitForCleanerWrites(bpm, 2);
+  std::this_thread::sleep_for(page_cleaner_interval * 5);
+  EXPECT_EQ(2, bpm->GetNumCleanerWrites());
+  log_manager->SetPersistentLSN(buffer_pool_size - 1);
+  WaitForCleanerWrites(bpm, buffer_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumCleanerWrites());
+
+  enable_logging = false;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  // The destructor stops the cleaner.
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+}  // namespace bustub
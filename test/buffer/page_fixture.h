@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_fixture.h
+//
+// Identification: test/buffer/page_fixture.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/*
+ * Test pages hold "Page <page_id>", so that a page read back can be told apart from any other page. Tests which keep
+ * the page header intact, e.g. the LSN, write the content offset bytes into the page.
+ */
+
+/** Write "Page <page_id>" into the page data, offset bytes into it. */
+inline void WritePageContent(char *data, page_id_t page_id, size_t offset = 0) {
+  snprintf(data + offset, PAGE_SIZE - offset, "Page %d", page_id);
+}
+
+/** @return true if the page data holds "Page <page_id>", offset bytes into it */
+inline bool HasPageContent(const char *data, page_id_t page_id, size_t offset = 0) {
+  char expected[PAGE_SIZE];
+  snprintf(expected, PAGE_SIZE, "Page %d", page_id);
+  return strcmp(data + offset, expected) == 0;
+}
+
+/** Fill a fresh database with num_pages pages, page i holding "Page i", and write them to disk. */
+inline void CreatePages(BufferPoolManager *bpm, size_t num_pages) {
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    WritePageContent(page->GetData(), page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+}
+
+/** Fetch a page, check that it holds "Page <page_id>" and unpin it. */
+inline void CheckPage(BufferPoolManager *bpm, page_id_t page_id, size_t offset = 0) {
+  auto *page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(HasPageContent(page->GetData(), page_id, offset));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+}
+
+/** Read a page from disk, bypassing the buffer pool, and check that it holds "Page <page_id>". */
+inline void CheckDiskPage(DiskManager *disk_manager, page_id_t page_id, size_t offset = 0) {
+  char data[PAGE_SIZE];
+  disk_manager->ReadPage(page_id, data);
+  EXPECT_TRUE(HasPageContent(data, page_id, offset));
+}
+
+}  // namespace bustub
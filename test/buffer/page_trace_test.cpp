@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_trace_test.cpp
+//
+// Identification: test/buffer/page_trace_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/page_trace_simulator.h"
+#include "gtest/gtest.h"
+#include "replacer_trace.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTraceTest, RecorderTest) {
+  const std::string db_name = "test.db";
+  const std::string trace_name = "test.trace";
+
+  for (size_t num_shards : {1, 2}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(4, disk_manager, nullptr, num_shards);
+    page_id_t page_id_temp;
+
+    // Scenario: only the references between start and stop are recorded, in order.
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+    ASSERT_TRUE(bpm->StartPageTrace(trace_name));
+    for (int i = 0; i < 2; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      bpm->UnpinPage(page_id_temp, false);
+    }
+    for (page_id_t page_id : {0, 1, 0, 2}) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    bpm->StopPageTrace();
+    ASSERT_NE(nullptr, bpm->FetchPage(0));
+    bpm->UnpinPage(0, false);
+
+    std::vector<PageTraceRecord> trace;
+    ASSERT_TRUE(PageTraceRecorder::ReadTrace(trace_name, &trace));
+    const std::vector<std::pair<PageTraceOp, page_id_t>> expected = {
+        {PageTraceOp::NEW, 1},   {PageTraceOp::NEW, 2},   {PageTraceOp::FETCH, 0},
+        {PageTraceOp::FETCH, 1}, {PageTraceOp::FETCH, 0}, {PageTraceOp::FETCH, 2}};
+    ASSERT_EQ(expected.size(), trace.size());
+    for (size_t i = 0; i < trace.size(); ++i) {
+      EXPECT_EQ(expected[i].first, trace[i].op_);
+      EXPECT_EQ(expected[i].second, trace[i].page_id_);
+      if (i > 0) {
+        EXPECT_LE(trace[i - 1].timestamp_, trace[i].timestamp_);
+      }
+    }
+
+    // Scenario: restarting truncates the file, and traces larger than the record buffer are complete.
+    ASSERT_TRUE(bpm->StartPageTrace(trace_name));
+    for (int i = 0; i < 10000; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i % 3));
+      bpm->UnpinPage(i % 3, false);
+    }
+    bpm->StopPageTrace();
+    ASSERT_TRUE(PageTraceRecorder::ReadTrace(trace_name, &trace));
+    ASSERT_EQ(10000, trace.size());
+    EXPECT_EQ(9999 % 3, trace.back().page_id_);
+
+    // Scenario: a swizzled fetch is recorded once, whether it misses the reference or hits it.
+    ASSERT_TRUE(bpm->StartPageTrace(trace_name));
+    SwizzledPageRef ref(1);
+    for (int i = 0; i < 2; ++i) {
+      Page *page = bpm->FetchSwizzled(&ref);
+      ASSERT_NE(nullptr, page);
+      EXPECT_TRUE(bpm->UnpinSwizzled(page, false));
+    }
+    bpm->StopPageTrace();
+    bpm->Unswizzle(&ref);
+    ASSERT_TRUE(PageTraceRecorder::ReadTrace(trace_name, &trace));
+    ASSERT_EQ(2, trace.size());
+    EXPECT_EQ(1, trace[0].page_id_);
+    EXPECT_EQ(1, trace[1].page_id_);
+
+    disk_manager->ShutDown();
+    remove(db_name.c_str());
+    remove(trace_name.c_str());
+    delete bpm;
+    delete disk_manager;
+  }
+  std::vector<PageTraceRecord> trace;
+  EXPECT_FALSE(PageTraceRecorder::ReadTrace(trace_name, &trace));
+}
+
+// NOLINTNEXTLINE
+TEST(PageTraceTest, SimulatorTest) {
+  auto fetches = [](const std::vector<page_id_t> &page_ids) {
+    std::vector<PageTraceRecord> trace;
+    for (page_id_t page_id : page_ids) {
+      trace.push_back({0, page_id, PageTraceOp::FETCH});
+    }
+    return trace;
+  };
+
+  // Scenario: a loop over one page more than the pool misses every time, unless the pool holds the whole loop.
+  PageTraceSimulator loop(fetches({1, 2, 3, 1, 2, 3, 1, 2, 3}));
+  EXPECT_EQ(3, loop.GetNumDistinctPages());
+  EXPECT_DOUBLE_EQ(1.0, loop.MissRatio(BufferPoolManager::ReplacerType::CLOCK, 2));
+  EXPECT_DOUBLE_EQ(3.0 / 9, loop.MissRatio(BufferPoolManager::ReplacerType::CLOCK, 3));
+  const std::vector<double> curve = loop.MissRatioCurve(BufferPoolManager::ReplacerType::LRU_K, {1, 3, 8});
+  ASSERT_EQ(3, curve.size());
+  EXPECT_DOUBLE_EQ(1.0, curve[0]);
+  EXPECT_DOUBLE_EQ(3.0 / 9, curve[1]);
+  EXPECT_DOUBLE_EQ(3.0 / 9, curve[2]);
+
+  // Scenario: a new page takes a frame, but it is not a miss and not a fetch.
+  PageTraceSimulator new_pages({{0, 1, PageTraceOp::NEW}, {0, 1, PageTraceOp::FETCH}, {0, 2, PageTraceOp::NEW},
+                                {0, 1, PageTraceOp::FETCH}});
+  EXPECT_DOUBLE_EQ(0.0, new_pages.MissRatio(BufferPoolManager::ReplacerType::ARC, 2));
+  EXPECT_DOUBLE_EQ(0.5, new_pages.MissRatio(BufferPoolManager::ReplacerType::ARC, 1));
+  EXPECT_DOUBLE_EQ(0.0, PageTraceSimulator({}).MissRatio(BufferPoolManager::ReplacerType::CLOCK, 1));
+}
+
+// Miss-ratio curves of every policy on a scan polluted Zipfian trace. Prints the curves.
+// NOLINTNEXTLINE
+TEST(PageTraceTest, DISABLED_MissRatioCurveBenchmark) {
+  const size_t num_hot_pages = 1024;
+  const size_t num_scan_pages = 4096;
+  std::vector<PageTraceRecord> trace;
+  for (page_id_t page_id : ScanPollutedZipfTrace(num_hot_pages, num_scan_pages, 200000)) {
+    trace.push_back({0, page_id, PageTraceOp::FETCH});
+  }
+  const size_t length = trace.size();
+  const PageTraceSimulator simulator(std::move(trace));
+  std::vector<size_t> pool_sizes = {32, 128, 512, 2048, simulator.GetNumDistinctPages()};
+
+  for (auto replacer_type : {BufferPoolManager::ReplacerType::CLOCK, BufferPoolManager::ReplacerType::LRU_K,
+                             BufferPoolManager::ReplacerType::ARC}) {
+    const std::vector<double> curve = simulator.MissRatioCurve(replacer_type, pool_sizes);
+    std::cout << (replacer_type == BufferPoolManager::ReplacerType::CLOCK
+                      ? "clock"
+                      : replacer_type == BufferPoolManager::ReplacerType::LRU_K ? "lru-k" : "arc");
+    for (size_t i = 0; i < pool_sizes.size(); ++i) {
+      std::cout << " " << pool_sizes[i] << ":" << curve[i];
+    }
+    std::cout << std::endl;
+    EXPECT_GT(curve.front(), curve.back());
+    // A pool holding every page only has compulsory misses.
+    EXPECT_DOUBLE_EQ(static_cast<double>(simulator.GetNumDistinctPages()) / static_cast<double>(length),
+                     curve.back());
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// partitioned_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/partitioned_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PartitionedBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_shards = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+  EXPECT_EQ(num_shards, bpm->GetNumShards());
+  EXPECT_EQ(buffer_pool_size, bpm->GetFreeListSize());
+
+  // Scenario: page ids are dense, so consecutive new pages are spread round robin over the shards
+  // and we can fill the whole pool.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %zu", i);
+    EXPECT_EQ(i + 1, bpm->GetPageTableSize());
+  }
+  EXPECT_EQ(0, bpm->GetFreeListSize());
+
+  // Scenario: every shard is full, so no more pages can be created.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+
+  // Scenario: unpinning frees frames in the owning shards only.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+    EXPECT_EQ(0, bpm->GetPagePinCount(i));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetReplacerSize());
+
+  // Scenario: evicted pages are written back and can be fetched again.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_FALSE(bpm->FindInBuffer(i));
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "Page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->FindInBuffer(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: deleting an unpinned page returns its frame to the free list of its shard.
+  EXPECT_TRUE(bpm->DeletePage(0));
+  EXPECT_FALSE(bpm->FindInBuffer(0));
+  EXPECT_EQ(1, bpm->GetFreeListSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PartitionedBufferPoolManagerTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_shards = 8;
+  const int num_threads = 8;
+  const int num_pages = 256;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  bpm->FlushAllPages();
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      for (int i = 0; i < 2000; ++i) {
+        const page_id_t page_id = dist(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->RLatch();
+        EXPECT_EQ(page_id, std::stoi(page->GetData()));
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetReplacerSize() + bpm->GetFreeListSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Thread scaling of cache hits: a single latch against a partitioned pool. Prints the throughput of each setup.
+// NOLINTNEXTLINE
+TEST(PartitionedBufferPoolManagerTest, DISABLED_ThreadScalingBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const int ops_per_thread = 100000;
+
+  for (size_t num_shards : {1, 16}) {
+    for (int num_threads : {1, 2, 4, 8}) {
+      auto *disk_manager = new DiskManager(db_name);
+      auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+      page_id_t page_id_temp;
+      for (size_t i = 0; i < buffer_pool_size; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+        bpm->UnpinPage(page_id_temp, false);
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([bpm, tid]() {
+          std::mt19937 gen(tid);
+          std::uniform_int_distribution<page_id_t> dist(0, buffer_pool_size - 1);
+          for (int i = 0; i < ops_per_thread; ++i) {
+            const page_id_t page_id = dist(gen);
+            bpm->FetchPage(page_id);
+            bpm->UnpinPage(page_id, false);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "shards: " << num_shards << " threads: " << num_threads
+                << " fetch+unpin/s: " << static_cast<int64_t>(num_threads * ops_per_thread / elapsed.count())
+                << std::endl;
+      // Every page is a hit, nothing is evicted.
+      EXPECT_EQ(buffer_pool_size, bpm->GetPageTableSize());
+
+      disk_manager->ShutDown();
+      remove("test.db");
+      delete bpm;
+      delete disk_manager;
+    }
+  }
+}
+
+}  // namespace bustub
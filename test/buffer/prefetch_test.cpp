@@ -0,0 +1,302 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetch_test.cpp
+//
+// Identification: test/buffer/prefetch_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Poll until the buffer pool prefetched num_prefetches pages, or give up after a second. */
+static void WaitForPrefetches(BufferPoolManager *bpm, size_t num_prefetches) {
+  for (int i = 0; i < 100 && bpm->GetNumPrefetches() < num_prefetches; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PrefetchTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+
+  for (size_t num_shards : {1, 4}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < num_pages; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Page %zu", i);
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+
+    // Scenario: prefetched pages are loaded in the background and left unpinned.
+    EXPECT_FALSE(bpm->FindInBuffer(0));
+    bpm->PrefetchRange(0, 8);
+    WaitForPrefetches(bpm, 8);
+    EXPECT_EQ(8, bpm->GetNumPrefetches());
+    for (page_id_t i = 0; i < 8; ++i) {
+      EXPECT_TRUE(bpm->FindInBuffer(i));
+      EXPECT_EQ(0, bpm->GetPagePinCount(i));
+    }
+
+    // Scenario: resident and unallocated pages are not prefetched.
+    EXPECT_FALSE(bpm->FindInBuffer(20));
+    bpm->Prefetch(0);
+    bpm->Prefetch(20);
+    bpm->Prefetch(static_cast<page_id_t>(num_pages));
+    bpm->PrefetchRange(static_cast<page_id_t>(num_pages) - 1, 8);
+    WaitForPrefetches(bpm, 9);
+    EXPECT_EQ(9, bpm->GetNumPrefetches());
+    EXPECT_TRUE(bpm->FindInBuffer(20));
+    EXPECT_FALSE(bpm->FindInBuffer(static_cast<page_id_t>(num_pages)));
+
+    // Scenario: fetching a prefetched page is a hit with the right content.
+    for (page_id_t i = 0; i < 8; ++i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      char expected[PAGE_SIZE];
+      snprintf(expected, PAGE_SIZE, "Page %d", i);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_TRUE(bpm->UnpinPage(i, false));
+    }
+
+    // Scenario: a page created while a prefetch of its id was in flight is a fresh page.
+    bpm->Prefetch(static_cast<page_id_t>(num_pages));
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(num_pages, page_id_temp);
+    EXPECT_EQ(0, page->GetData()[0]);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+
+    // Scenario: racing prefetches of new pages never leave a page id mapped to two frames. Every resident frame is
+    // in the page table, and every page keeps its content.
+    const auto first_new_page_id = static_cast<page_id_t>(num_pages) + 1;
+    for (page_id_t i = first_new_page_id; i < first_new_page_id + 64; ++i) {
+      bpm->PrefetchRange(i, 2);
+      page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      ASSERT_EQ(i, page_id_temp);
+      snprintf(page->GetData(), PAGE_SIZE, "Page %d", i);
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+    EXPECT_EQ(buffer_pool_size - bpm->GetFreeListSize(), bpm->GetPageTableSize());
+    for (page_id_t i = first_new_page_id; i < first_new_page_id + 64; ++i) {
+      page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      char expected[PAGE_SIZE];
+      snprintf(expected, PAGE_SIZE, "Page %d", i);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_TRUE(bpm->UnpinPage(i, false));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PrefetchTest, PinnedStaleFrameTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(4, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: page 5 is deleted, but someone still fetches its id and keeps the pin. Creating a page reuses the id,
+  // so it waits for the pin, without keeping other misses out meanwhile.
+  EXPECT_TRUE(bpm->DeletePage(5));
+  ASSERT_NE(nullptr, bpm->FetchPage(5));
+  std::atomic<bool> created{false};
+  std::thread creator([bpm, &created] {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(5, page_id);
+    EXPECT_EQ(0, page->GetData()[0]);
+    created = true;
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(created);
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_FALSE(created);
+  EXPECT_TRUE(bpm->UnpinPage(5, false));
+  creator.join();
+  EXPECT_TRUE(created);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PrefetchTest, ReserveTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t i = 12; i < 16; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+  }
+
+  // Scenario: four frames are evictable. A prefetch of four pages claims only two of them, the others are left to
+  // fetches running meanwhile.
+  bpm->PrefetchRange(0, 4);
+  WaitForPrefetches(bpm, 3);
+  EXPECT_EQ(2, bpm->GetNumPrefetches());
+  EXPECT_TRUE(bpm->FindInBuffer(0));
+  EXPECT_TRUE(bpm->FindInBuffer(1));
+  EXPECT_FALSE(bpm->FindInBuffer(2));
+  for (page_id_t i = 12; i < 16; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PrefetchTest, BulkScanTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 32;
+  const int num_tuples = 1000;
+  const size_t default_read_ahead_pages = table_read_ahead_pages;
+  table_read_ahead_pages = 8;
+
+  Schema schema{std::vector<Column>{{"a", TypeId::INTEGER}, {"b", TypeId::VARCHAR, 256}}};
+  auto *disk_manager = new DiskManager(db_name);
+  auto *transaction = new Transaction(0);
+  page_id_t first_page_id;
+  {
+    BufferPoolManager bpm(num_tuples / 8, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, transaction);
+    first_page_id = table.GetFirstPageId();
+    const std::string padding(200, 'x');
+    for (int i = 0; i < num_tuples; ++i) {
+      RID rid;
+      ASSERT_TRUE(table.InsertTuple(Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(padding)},
+                                          &schema),
+                                    &rid, transaction));
+    }
+    bpm.FlushAllPages();
+  }
+
+  // Scenario: a scan with a bulk access strategy stays inside its ring and does not read ahead into the shared pool.
+  BufferPoolManager bpm(buffer_pool_size, disk_manager);
+  TableHeap table(&bpm, nullptr, nullptr, first_page_id);
+  BufferAccessStrategy strategy(&bpm);
+  int count = 0;
+  for (auto itr = table.Begin(transaction, &strategy); itr != table.End(); ++itr) {
+    EXPECT_EQ(count++, itr->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, count);
+  WaitForPrefetches(&bpm, 1);
+  EXPECT_EQ(0, bpm.GetNumPrefetches());
+  EXPECT_GE(strategy.GetRingSize(), bpm.GetPageTableSize());
+
+  // Scenario: the same scan without a strategy reads ahead.
+  count = 0;
+  for (auto itr = table.Begin(transaction); itr != table.End(); ++itr) {
+    EXPECT_EQ(count++, itr->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, count);
+  WaitForPrefetches(&bpm, 1);
+  EXPECT_LT(0, bpm.GetNumPrefetches());
+  table_read_ahead_pages = default_read_ahead_pages;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete transaction;
+  delete disk_manager;
+}
+
+// Cold sequential scan of a table heap, with and without read-ahead. Prints the throughput of each setup.
+// NOLINTNEXTLINE
+TEST(PrefetchTest, DISABLED_ColdScanBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 32;
+  const int num_tuples = 4000;
+  const size_t default_read_ahead_pages = table_read_ahead_pages;
+
+  Schema schema{std::vector<Column>{{"a", TypeId::INTEGER}, {"b", TypeId::VARCHAR, 256}}};
+  auto *disk_manager = new DiskManager(db_name);
+  auto *transaction = new Transaction(0);
+  page_id_t first_page_id;
+  {
+    // Load the table into a pool large enough to hold it, and write it to disk.
+    BufferPoolManager bpm(num_tuples / 8, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, transaction);
+    first_page_id = table.GetFirstPageId();
+    const std::string padding(200, 'x');
+    for (int i = 0; i < num_tuples; ++i) {
+      RID rid;
+      ASSERT_TRUE(table.InsertTuple(Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(padding)},
+                                          &schema),
+                                    &rid, transaction));
+    }
+    bpm.FlushAllPages();
+  }
+
+  for (size_t read_ahead_pages : {0, 4, 16}) {
+    table_read_ahead_pages = read_ahead_pages;
+    BufferPoolManager bpm(buffer_pool_size, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, first_page_id);
+    const auto start = std::chrono::steady_clock::now();
+    int count = 0;
+    for (auto itr = table.Begin(transaction); itr != table.End(); ++itr) {
+      EXPECT_EQ(count++, itr->GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(num_tuples, count);
+    if (read_ahead_pages > 0) {
+      EXPECT_LT(0, bpm.GetNumPrefetches());
+    }
+    std::cout << "read-ahead pages: " << read_ahead_pages << " prefetched: " << bpm.GetNumPrefetches()
+              << " tuples/s: " << static_cast<int64_t>(num_tuples / elapsed.count()) << std::endl;
+  }
+  table_read_ahead_pages = default_read_ahead_pages;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete transaction;
+  delete disk_manager;
+}
+
+}  // namespace bustub
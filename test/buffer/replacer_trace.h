@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_trace.h
+//
+// Identification: test/buffer/replacer_trace.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** A trace of page references: a Zipfian hot set, polluted by sequential scans over a table larger than the pool. */
+inline std::vector<page_id_t> ScanPollutedZipfTrace(size_t num_hot_pages, size_t num_scan_pages, size_t length) {
+  constexpr double zipf_exponent = 0.99;
+  constexpr size_t accesses_between_scans = 200;
+  constexpr size_t scan_length = 64;
+  constexpr int references_per_scan_page = 4;
+
+  std::vector<double> cdf(num_hot_pages);
+  double sum = 0;
+  for (size_t i = 0; i < num_hot_pages; ++i) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), zipf_exponent);
+    cdf[i] = sum;
+  }
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(0, sum);
+  std::vector<page_id_t> trace;
+  size_t scan_position = 0;
+  while (trace.size() < length) {
+    for (size_t i = 0; i < accesses_between_scans; ++i) {
+      trace.push_back(static_cast<page_id_t>(std::lower_bound(cdf.begin(), cdf.end(), dist(gen)) - cdf.begin()));
+    }
+    // A scan reads tuple after tuple, so it references each page several times in a row.
+    for (size_t i = 0; i < scan_length; ++i, scan_position = (scan_position + 1) % num_scan_pages) {
+      for (int j = 0; j < references_per_scan_page; ++j) {
+        trace.push_back(static_cast<page_id_t>(num_hot_pages + scan_position));
+      }
+    }
+  }
+  return trace;
+}
+
+/** Replay the trace with fetch and unpin, and return the hit ratio of the buffer pool. */
+inline double ReplayTrace(BufferPoolManager::ReplacerType replacer_type, size_t buffer_pool_size,
+                          const std::vector<page_id_t> &trace, size_t num_pages) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, 1, replacer_type);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+  bpm->FlushAllPages();
+
+  size_t hits = 0;
+  for (page_id_t page_id : trace) {
+    hits += bpm->FindInBuffer(page_id) ? 1 : 0;
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+  return static_cast<double>(hits) / static_cast<double>(trace.size());
+}
+
+}  // namespace bustub
@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// resize_test.cpp
+//
+// Identification: test/buffer/resize_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "page_fixture.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ResizeTest, SampleTest) {
+  const std::string db_name = "test.db";
+
+  for (size_t num_shards : {1, 4}) {
+    for (auto replacer_type : {BufferPoolManager::ReplacerType::LOCK_FREE_CLOCK, BufferPoolManager::ReplacerType::ARC}) {
+      auto *disk_manager = new DiskManager(db_name);
+      auto *bpm = new BufferPoolManager(8, disk_manager, nullptr, num_shards, replacer_type, 32);
+      EXPECT_EQ(8, bpm->GetPoolSize());
+      EXPECT_EQ(32, bpm->GetMaxPoolSize());
+
+      // Scenario: the pool only hands out its own frames.
+      std::vector<page_id_t> page_ids;
+      page_id_t page_id_temp;
+      for (int i = 0; i < 8; ++i) {
+        auto *page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        WritePageContent(page->GetData(), page_id_temp);
+        page_ids.push_back(page_id_temp);
+      }
+      EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+      // Scenario: growing adds free frames, the resident pages stay where they are.
+      EXPECT_FALSE(bpm->Resize(33));
+      EXPECT_TRUE(bpm->Resize(32));
+      EXPECT_EQ(32, bpm->GetPoolSize());
+      EXPECT_EQ(24, bpm->GetFreeListSize());
+      for (int i = 8; i < 32; ++i) {
+        auto *page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        WritePageContent(page->GetData(), page_id_temp);
+        page_ids.push_back(page_id_temp);
+      }
+      EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+      for (page_id_t page_id : page_ids) {
+        EXPECT_EQ(1, bpm->GetPagePinCount(page_id));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      }
+
+      // Scenario: shrinking evicts the pages of the dropped frames and writes the dirty ones back.
+      EXPECT_FALSE(bpm->Resize(num_shards - 1));
+      EXPECT_TRUE(bpm->Resize(8));
+      EXPECT_EQ(8, bpm->GetPoolSize());
+      EXPECT_EQ(8, bpm->GetPageTableSize());
+      EXPECT_EQ(8, bpm->GetReplacerSize());
+      EXPECT_EQ(0, bpm->GetFreeListSize());
+      for (page_id_t page_id : page_ids) {
+        CheckPage(bpm, page_id);
+      }
+      EXPECT_EQ(8, bpm->GetPageTableSize());
+
+      // Scenario: shrinking waits for a pinned page of a dropped frame.
+      EXPECT_TRUE(bpm->Resize(16));
+      for (size_t i = 0; i < 16; ++i) {
+        ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+      }
+      std::atomic<bool> resized{false};
+      std::thread resizer([bpm, num_shards, &resized] {
+        EXPECT_TRUE(bpm->Resize(num_shards));
+        resized = true;
+      });
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      EXPECT_FALSE(resized);
+      for (size_t i = 0; i < 16; ++i) {
+        EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+      }
+      resizer.join();
+      EXPECT_EQ(num_shards, bpm->GetPoolSize());
+      EXPECT_EQ(num_shards, bpm->GetPageTableSize());
+      for (page_id_t page_id : page_ids) {
+        CheckPage(bpm, page_id);
+      }
+
+      disk_manager->ShutDown();
+      remove("test.db");
+      delete bpm;
+      delete disk_manager;
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ResizeTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const size_t num_pages = 64;
+  const int num_threads = 4;
+
+  for (size_t num_shards : {1, 4}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(16, disk_manager, nullptr, num_shards,
+                                      BufferPoolManager::ReplacerType::LOCK_FREE_CLOCK, 64);
+    CreatePages(bpm, num_pages);
+
+    // Readers keep going while the pool grows and shrinks under them.
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([bpm, &done, tid] {
+        std::mt19937 gen(tid);
+        while (!done) {
+          const auto page_id = static_cast<page_id_t>(gen() % num_pages);
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            // Every frame of the shrunk pool is pinned by the other threads.
+            continue;
+          }
+          page->RLatch();
+          EXPECT_TRUE(HasPageContent(page->GetData(), page_id));
+          page->RUnlatch();
+          EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+        }
+      });
+    }
+    for (size_t new_pool_size : {64, 8, 32, 4 * num_threads, 48, 8, 16}) {
+      EXPECT_TRUE(bpm->Resize(new_pool_size));
+      EXPECT_EQ(new_pool_size, bpm->GetPoolSize());
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    done = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_GE(16, bpm->GetPageTableSize());
+    for (page_id_t i = 0; i < static_cast<page_id_t>(num_pages); ++i) {
+      CheckPage(bpm, i);
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
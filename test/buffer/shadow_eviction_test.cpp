@@ -0,0 +1,259 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// shadow_eviction_test.cpp
+//
+// Identification: test/buffer/shadow_eviction_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "page_fixture.h"
+
+namespace bustub {
+
+/** The content of the test pages starts behind the page header, which holds the LSN. */
+static constexpr size_t CONTENT_OFFSET = 8;
+
+// NOLINTNEXTLINE
+TEST(ShadowEvictionTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 16;
+  const size_t default_staging_pages = write_back_staging_pages;
+
+  for (size_t num_shards : {1, 4}) {
+    for (size_t staging_pages : {default_staging_pages, static_cast<size_t>(0)}) {
+      write_back_staging_pages = staging_pages;
+      auto *disk_manager = new DiskManager(db_name);
+      auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+      page_id_t page_id_temp;
+      for (size_t i = 0; i < num_pages; ++i) {
+        auto *page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        WritePageContent(page->GetData(), page_id_temp, CONTENT_OFFSET);
+        EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+      }
+
+      // Scenario: evicted pages are fetched back intact, whether their write-back is pending or done.
+      for (page_id_t i = 0; i < static_cast<page_id_t>(num_pages); ++i) {
+        CheckPage(bpm, i, CONTENT_OFFSET);
+      }
+
+      // Scenario: with staging, no eviction writes in the foreground. Flushing waits for the pending write-backs.
+      bpm->FlushAllPages();
+      if (staging_pages > 0) {
+        EXPECT_EQ(0, bpm->GetNumForegroundWrites());
+        EXPECT_LT(0, bpm->GetNumStagedWrites());
+      } else {
+        // Every page was evicted dirty once: on creation, or while the pages were checked.
+        EXPECT_EQ(num_pages, bpm->GetNumForegroundWrites());
+        EXPECT_EQ(0, bpm->GetNumStagedWrites());
+      }
+      for (page_id_t i = 0; i < static_cast<page_id_t>(num_pages); ++i) {
+        CheckDiskPage(disk_manager, i, CONTENT_OFFSET);
+      }
+
+      disk_manager->ShutDown();
+      remove("test.db");
+      delete bpm;
+      delete disk_manager;
+    }
+  }
+  write_back_staging_pages = default_staging_pages;
+}
+
+// NOLINTNEXTLINE
+TEST(ShadowEvictionTest, WriteBackTest) {
+  const std::string db_name = "test.db";
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManager(2, disk_manager, log_manager);
+  // The log is not flushed until the flush thread runs, so the write-back thread stalls on the first staged victim.
+  enable_logging = true;
+
+  // Every new page beyond the pool size evicts a dirty page without waiting for its write. The first victim is
+  // being written, the second one is queued.
+  std::vector<page_id_t> victims;
+  page_id_t page_id_temp;
+  for (int i = 0; i < 4; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    WritePageContent(page->GetData(), page_id_temp, CONTENT_OFFSET);
+    page->SetLSN(1);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    for (page_id_t j = 0; j <= page_id_temp; ++j) {
+      if (!bpm->FindInBuffer(j) && std::find(victims.begin(), victims.end(), j) == victims.end()) {
+        victims.push_back(j);
+      }
+    }
+  }
+  ASSERT_EQ(2, victims.size());
+  EXPECT_EQ(2, bpm->GetNumEvictions());
+  EXPECT_EQ(0, bpm->GetNumForegroundWrites());
+  EXPECT_EQ(0, bpm->GetNumStagedWrites());
+
+  // Scenario: a queued victim is fetched back from the staging buffer, its write stays queued.
+  CheckPage(bpm, victims[1], CONTENT_OFFSET);
+
+  // Scenario: a victim being written is copied from the staging buffer, but the fetch waits for the write.
+  std::atomic<bool> fetched{false};
+  std::thread fetcher([bpm, &fetched, &victims] {
+    CheckPage(bpm, victims[0], CONTENT_OFFSET);
+    fetched = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(fetched);
+  enable_logging = false;
+  log_manager->RunFlushThread();
+  fetcher.join();
+  EXPECT_TRUE(fetched);
+  EXPECT_LE(1, bpm->GetNumStagedWrites());
+  CheckDiskPage(disk_manager, victims[0], CONTENT_OFFSET);
+
+  // Scenario: after a flush, every page is on disk.
+  bpm->FlushAllPages();
+  EXPECT_EQ(0, bpm->GetNumForegroundWrites());
+  for (page_id_t i = 0; i < 4; ++i) {
+    CheckDiskPage(disk_manager, i, CONTENT_OFFSET);
+  }
+
+  log_manager->StopFlushThread();
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ShadowEvictionTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const int num_threads = 4;
+  const int num_pages = 64;
+  const int num_updates = 5000;
+  const size_t default_staging_pages = write_back_staging_pages;
+
+  // Two staging slots are often all taken, then evictions fall back to foreground writes.
+  for (size_t staging_pages : {default_staging_pages, static_cast<size_t>(2)}) {
+    for (size_t num_shards : {1, 4}) {
+      write_back_staging_pages = staging_pages;
+      auto *disk_manager = new DiskManager(db_name);
+      auto *bpm = new BufferPoolManager(16, disk_manager, nullptr, num_shards);
+      page_id_t page_id_temp;
+      for (int i = 0; i < num_pages; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+        EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+      }
+
+      // Every thread counts the updates of its own pages. An update lost by an eviction, or a stale read of a page
+      // whose write-back is pending, breaks the count.
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([bpm, tid] {
+          std::mt19937 gen(tid);
+          std::vector<int> counts(num_pages / num_threads, 0);
+          for (int i = 0; i < num_updates; ++i) {
+            const auto slot = static_cast<int>(gen() % counts.size());
+            const page_id_t page_id = slot * num_threads + tid;
+            auto *page = bpm->FetchPage(page_id);
+            if (page == nullptr) {
+              continue;
+            }
+            int count;
+            memcpy(&count, page->GetData(), sizeof(count));
+            EXPECT_EQ(counts[slot], count);
+            counts[slot] = count + 1;
+            memcpy(page->GetData(), &counts[slot], sizeof(count));
+            EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      EXPECT_LT(0, bpm->GetNumEvictions());
+
+      disk_manager->ShutDown();
+      remove("test.db");
+      delete bpm;
+      delete disk_manager;
+    }
+  }
+  write_back_staging_pages = default_staging_pages;
+}
+
+// Random updates of a table four times the size of the pool, so that most fetches evict a dirty page, with direct
+// I/O. Prints the update latency without staging, where every eviction writes its victim back in the foreground, and
+// with staging.
+// NOLINTNEXTLINE
+TEST(ShadowEvictionTest, DISABLED_ShadowEvictionBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const int num_pages = 1024;
+  const int num_threads = 4;
+  const int num_updates = 5000;
+  const size_t default_staging_pages = write_back_staging_pages;
+
+  for (size_t staging_pages : {static_cast<size_t>(0), default_staging_pages}) {
+    write_back_staging_pages = staging_pages;
+    auto *disk_manager = new DiskManager(db_name, true);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([bpm, tid] {
+        std::mt19937 gen(tid);
+        for (int i = 0; i < num_updates; ++i) {
+          const auto page_id = static_cast<page_id_t>(gen() % num_pages);
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          page->WLatch();
+          page->GetData()[CONTENT_OFFSET]++;
+          page->WUnlatch();
+          bpm->UnpinPage(page_id, true);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "staging pages: " << staging_pages << " us/update: " << elapsed.count() / (num_threads * num_updates)
+              << " foreground writes: " << bpm->GetNumForegroundWrites()
+              << " staged writes: " << bpm->GetNumStagedWrites() << std::endl;
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+  write_back_staging_pages = default_staging_pages;
+}
+
+}  // namespace bustub
@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// swizzle_test.cpp
+//
+// Identification: test/buffer/swizzle_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/index/int_comparator.h"
+
+namespace bustub {
+
+/** Fetch a page through its reference, check that it holds "Page <page_id>" and unpin it. */
+static void CheckSwizzled(BufferPoolManager *bpm, SwizzledPageRef *ref) {
+  auto *page = bpm->FetchSwizzled(ref);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(ref->GetPageId(), page->GetPageId());
+  char expected[PAGE_SIZE];
+  snprintf(expected, PAGE_SIZE, "Page %d", ref->GetPageId());
+  EXPECT_EQ(0, strcmp(page->GetData(), expected));
+  EXPECT_TRUE(bpm->UnpinSwizzled(page, false));
+}
+
+// NOLINTNEXTLINE
+TEST(SwizzleTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+
+  for (size_t num_shards : {1, 4}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards);
+    std::vector<page_id_t> page_ids;
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < num_pages; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+      page_ids.push_back(page_id_temp);
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+
+    // Scenario: the first fetch swizzles the reference, the next ones pin the same frame.
+    SwizzledPageRef ref(page_ids[0]);
+    EXPECT_FALSE(ref.IsSwizzled());
+    CheckSwizzled(bpm, &ref);
+    EXPECT_TRUE(ref.IsSwizzled());
+    auto *page = bpm->FetchSwizzled(&ref);
+    EXPECT_EQ(page, bpm->FetchPage(page_ids[0]));
+    EXPECT_EQ(2, bpm->GetPagePinCount(page_ids[0]));
+    EXPECT_TRUE(bpm->UnpinSwizzled(page, true));
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[0], false));
+    EXPECT_EQ(0, bpm->GetPagePinCount(page_ids[0]));
+    EXPECT_FALSE(bpm->UnpinSwizzled(page, false));
+
+    // Scenario: a frame is swizzled by one reference at a time, a second reference still fetches the page.
+    SwizzledPageRef other_ref(page_ids[0]);
+    CheckSwizzled(bpm, &other_ref);
+    EXPECT_FALSE(other_ref.IsSwizzled());
+
+    // Scenario: evicting the page unswizzles the reference, the next fetch reads the page and swizzles it again.
+    for (size_t i = 1; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+    }
+    EXPECT_FALSE(bpm->FindInBuffer(page_ids[0]));
+    EXPECT_FALSE(ref.IsSwizzled());
+    CheckSwizzled(bpm, &ref);
+    EXPECT_TRUE(ref.IsSwizzled());
+
+    // Scenario: deleting the page unswizzles the reference.
+    EXPECT_TRUE(bpm->DeletePage(page_ids[0]));
+    EXPECT_FALSE(ref.IsSwizzled());
+
+    // Scenario: an owner unswizzles its reference, and the frame can be swizzled by another one.
+    {
+      SwizzledPageRef short_lived(page_ids[1]);
+      CheckSwizzled(bpm, &short_lived);
+      EXPECT_TRUE(short_lived.IsSwizzled());
+      bpm->Unswizzle(&short_lived);
+      EXPECT_FALSE(short_lived.IsSwizzled());
+    }
+    SwizzledPageRef long_lived(page_ids[1]);
+    CheckSwizzled(bpm, &long_lived);
+    EXPECT_TRUE(long_lived.IsSwizzled());
+    bpm->Unswizzle(&long_lived);
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SwizzleTest, HashTableTest) {
+  const std::string db_name = "test.db";
+  const int num_keys = 2000;
+
+  enable_pointer_swizzling = true;
+  auto *disk_manager = new DiskManager(db_name);
+  // Fewer frames than block pages, so that probes keep unswizzling and swizzling the references.
+  auto *bpm = new BufferPoolManager(4, disk_manager);
+  {
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 2 * num_keys,
+                                                     HashFunction<int>());
+    for (int i = 0; i < num_keys; i++) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    }
+    for (int i = 0; i < num_keys; i++) {
+      std::vector<int> res;
+      EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+      ASSERT_EQ(1, res.size());
+      EXPECT_EQ(i, res[0]);
+    }
+    for (int i = 0; i < num_keys; i += 2) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    }
+    ht.Resize(4 * num_keys);
+    for (int i = 0; i < num_keys; i++) {
+      std::vector<int> res;
+      EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res));
+    }
+    // Every page fetched through a reference was unpinned again.
+    EXPECT_EQ(4, bpm->GetReplacerSize() + bpm->GetFreeListSize());
+  }
+  enable_pointer_swizzling = false;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// Fetches of resident pages by page id and through swizzled references: a scan over the pages of a table, and point
+// probes of a hash table whose block pages stay in the pool. Prints the throughput of each.
+// NOLINTNEXTLINE
+TEST(SwizzleTest, DISABLED_SwizzleBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t num_pages = 256;
+  const int num_scans = 2000;
+  const int num_keys = 100000;
+  const int num_probes = 1000000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(2048, disk_manager);
+  std::deque<SwizzledPageRef> refs;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+    refs.emplace_back(page_id_temp);
+  }
+
+  for (bool swizzled : {false, true}) {
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < num_scans; ++scan) {
+      for (auto &ref : refs) {
+        if (swizzled) {
+          auto *page = bpm->FetchSwizzled(&ref);
+          checksum += static_cast<uint64_t>(page->GetData()[0]);
+          bpm->UnpinSwizzled(page, false);
+        } else {
+          auto *page = bpm->FetchPage(ref.GetPageId());
+          checksum += static_cast<uint64_t>(page->GetData()[0]);
+          bpm->UnpinPage(ref.GetPageId(), false);
+        }
+      }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(0, checksum);
+    std::cout << "scan swizzled: " << swizzled
+              << " page fetches/s: " << static_cast<int64_t>(num_scans * num_pages / elapsed.count()) << std::endl;
+  }
+  for (auto &ref : refs) {
+    bpm->Unswizzle(&ref);
+  }
+
+  for (bool swizzled : {false, true}) {
+    enable_pointer_swizzling = swizzled;
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 2 * num_keys, HashFunction<int>());
+    for (int i = 0; i < num_keys; i++) {
+      ht.Insert(nullptr, i, i);
+    }
+    std::vector<int> res;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_probes; i++) {
+      res.clear();
+      ht.GetValue(nullptr, static_cast<int>((i * 7919L) % num_keys), &res);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "hash probe swizzled: " << swizzled
+              << " probes/s: " << static_cast<int64_t>(num_probes / elapsed.count()) << std::endl;
+  }
+  enable_pointer_swizzling = false;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
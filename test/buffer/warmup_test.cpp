@@ -0,0 +1,187 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// warmup_test.cpp
+//
+// Identification: test/buffer/warmup_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "page_fixture.h"
+
+namespace bustub {
+
+/** Read the page ids of a warm-up snapshot. */
+static std::vector<page_id_t> ReadSnapshot(const std::string &file_name) {
+  std::ifstream file(file_name, std::ios::binary | std::ios::in | std::ios::ate);
+  std::vector<page_id_t> page_ids(static_cast<size_t>(file.tellg()) / sizeof(page_id_t));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(page_ids.data()),
+            static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+  return page_ids;
+}
+
+// NOLINTNEXTLINE
+TEST(WarmupTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const std::string snapshot_name = "test.warmup";
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+
+  for (size_t num_shards : {1, 4}) {
+    for (auto replacer_type : {BufferPoolManager::ReplacerType::LOCK_FREE_CLOCK, BufferPoolManager::ReplacerType::LRU_K,
+                               BufferPoolManager::ReplacerType::ARC}) {
+      remove(snapshot_name.c_str());
+      auto *disk_manager = new DiskManager(db_name);
+      auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards, replacer_type);
+      // Scenario: without a snapshot there is nothing to warm up.
+      EXPECT_FALSE(bpm->EnableWarmupSnapshot(snapshot_name));
+      CreatePages(bpm, num_pages);
+      // The hot set 40..47 is referenced over and over, while pages 0..7 pass through once.
+      for (int round = 0; round < 4; ++round) {
+        for (page_id_t i = 40; i < 48; ++i) {
+          CheckPage(bpm, i);
+        }
+      }
+      for (page_id_t i = 0; i < 8; ++i) {
+        CheckPage(bpm, i);
+      }
+
+      // Scenario: the snapshot saved on destruction holds the resident pages.
+      delete bpm;
+      std::vector<page_id_t> snapshot = ReadSnapshot(snapshot_name);
+      EXPECT_EQ(buffer_pool_size, snapshot.size());
+      if (replacer_type != BufferPoolManager::ReplacerType::LOCK_FREE_CLOCK) {
+        // Scan resistant policies rank the hot set first.
+        std::vector<page_id_t> hottest(snapshot.begin(), snapshot.begin() + 8);
+        std::sort(hottest.begin(), hottest.end());
+        EXPECT_EQ(40, hottest.front());
+        EXPECT_EQ(47, hottest.back());
+      }
+
+      // Scenario: a restarted pool loads the snapshot in the background.
+      bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards, replacer_type);
+      EXPECT_TRUE(bpm->EnableWarmupSnapshot(snapshot_name));
+      bpm->WaitForWarmup();
+      EXPECT_EQ(buffer_pool_size, bpm->GetNumWarmupPages());
+      for (page_id_t page_id : snapshot) {
+        EXPECT_TRUE(bpm->FindInBuffer(page_id));
+        EXPECT_EQ(0, bpm->GetPagePinCount(page_id));
+      }
+      for (page_id_t page_id : snapshot) {
+        CheckPage(bpm, page_id);
+      }
+      delete bpm;
+
+      // Scenario: a smaller pool only loads the hottest pages of the snapshot.
+      snapshot = ReadSnapshot(snapshot_name);
+      bpm = new BufferPoolManager(buffer_pool_size / 2, disk_manager, nullptr, num_shards, replacer_type);
+      EXPECT_TRUE(bpm->EnableWarmupSnapshot(snapshot_name));
+      bpm->WaitForWarmup();
+      EXPECT_EQ(buffer_pool_size / 2, bpm->GetNumWarmupPages());
+      for (size_t i = 0; i < buffer_pool_size / 2; ++i) {
+        EXPECT_TRUE(bpm->FindInBuffer(snapshot[i]));
+      }
+      delete bpm;
+
+      // Scenario: ids which were never allocated, or are not page ids at all, are skipped.
+      {
+        std::ofstream file(snapshot_name, std::ios::binary | std::ios::out | std::ios::trunc);
+        const std::vector<page_id_t> bad_snapshot = {INVALID_PAGE_ID, 3, -7, static_cast<page_id_t>(num_pages), 5,
+                                                     1 << 30};
+        file.write(reinterpret_cast<const char *>(bad_snapshot.data()),
+                   static_cast<std::streamsize>(bad_snapshot.size() * sizeof(page_id_t)));
+      }
+      bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, num_shards, replacer_type);
+      EXPECT_TRUE(bpm->EnableWarmupSnapshot(snapshot_name));
+      bpm->WaitForWarmup();
+      EXPECT_EQ(2U, bpm->GetNumWarmupPages());
+      EXPECT_TRUE(bpm->FindInBuffer(3));
+      EXPECT_TRUE(bpm->FindInBuffer(5));
+      EXPECT_FALSE(bpm->FindInBuffer(static_cast<page_id_t>(num_pages)));
+      CheckPage(bpm, 3);
+      CheckPage(bpm, 5);
+      delete bpm;
+
+      disk_manager->ShutDown();
+      remove(db_name.c_str());
+      remove(snapshot_name.c_str());
+      delete disk_manager;
+    }
+  }
+}
+
+// Latency of the first requests after a restart, with a cold pool and with a pool warmed up from a snapshot. Prints
+// the time the warm-up took before the traffic started, and the latency of the traffic.
+// NOLINTNEXTLINE
+TEST(WarmupTest, DISABLED_RestartBenchmark) {
+  const std::string db_name = "test.db";
+  const std::string snapshot_name = "test.warmup";
+  const size_t buffer_pool_size = 256;
+  const size_t num_pages = 1024;
+  const int num_requests = 2000;
+
+  remove(snapshot_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, true);
+  {
+    BufferPoolManager bpm(buffer_pool_size, disk_manager, nullptr, 1, BufferPoolManager::ReplacerType::LRU_K);
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(&page_id_temp));
+      EXPECT_TRUE(bpm.UnpinPage(page_id_temp, true));
+    }
+    bpm.FlushAllPages();
+    // The working set is spread over the file, so that cold misses are random reads.
+    std::mt19937 gen(0);
+    for (int i = 0; i < num_requests; ++i) {
+      const auto page_id = static_cast<page_id_t>(gen() % buffer_pool_size * (num_pages / buffer_pool_size));
+      ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+      EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    EXPECT_TRUE(bpm.SaveWarmupSnapshot(snapshot_name));
+  }
+
+  for (bool warm : {false, true}) {
+    BufferPoolManager bpm(buffer_pool_size, disk_manager, nullptr, 1, BufferPoolManager::ReplacerType::LRU_K);
+    const auto start = std::chrono::steady_clock::now();
+    if (warm) {
+      EXPECT_TRUE(bpm.EnableWarmupSnapshot(snapshot_name));
+      bpm.WaitForWarmup();
+    }
+    const auto traffic_start = std::chrono::steady_clock::now();
+    std::mt19937 gen(1);
+    for (int i = 0; i < num_requests; ++i) {
+      const auto page_id = static_cast<page_id_t>(gen() % buffer_pool_size * (num_pages / buffer_pool_size));
+      ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+      EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const std::chrono::duration<double, std::micro> warmup_time = traffic_start - start;
+    const std::chrono::duration<double, std::micro> traffic_time = end - traffic_start;
+    std::cout << "warm start: " << warm << " warm-up us: " << static_cast<int64_t>(warmup_time.count())
+              << " warm-up pages: " << bpm.GetNumWarmupPages()
+              << " us/request: " << traffic_time.count() / num_requests << std::endl;
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(snapshot_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
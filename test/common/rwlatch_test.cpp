@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include <thread>  // NOLINT
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <shared_mutex>  // NOLINT
+#include <thread>        // NOLINT
 #include <vector>
 
 #include "common/rwlatch.h"
@@ -39,6 +43,11 @@ class Counter {
   ReaderWriterLatch mutex{};
 };
 
+void Lock(ReaderWriterLatch *latch, bool exclusive) { exclusive ? latch->WLock() : latch->RLock(); }
+void Unlock(ReaderWriterLatch *latch, bool exclusive) { exclusive ? latch->WUnlock() : latch->RUnlock(); }
+void Lock(std::shared_mutex *latch, bool exclusive) { exclusive ? latch->lock() : latch->lock_shared(); }
+void Unlock(std::shared_mutex *latch, bool exclusive) { exclusive ? latch->unlock() : latch->unlock_shared(); }
+
 // NOLINTNEXTLINE
 TEST(RWLatchTest, BasicTest) {
   int num_threads = 100;
@@ -57,4 +66,120 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, TryRLockTest) {
+  ReaderWriterLatch latch;
+  // Scenario: readers share the latch, a writer keeps them out.
+  EXPECT_TRUE(latch.TryRLock());
+  EXPECT_TRUE(latch.TryRLock());
+  latch.RUnlock();
+  latch.RUnlock();
+  latch.WLock();
+  EXPECT_FALSE(latch.TryRLock());
+  latch.WUnlock();
+
+  // Scenario: a waiting writer keeps new readers out too.
+  latch.RLock();
+  std::thread writer([&latch]() {
+    latch.WLock();
+    latch.WUnlock();
+  });
+  while (latch.TryRLock()) {
+    latch.RUnlock();
+    std::this_thread::yield();
+  }
+  latch.RUnlock();
+  writer.join();
+  EXPECT_TRUE(latch.TryRLock());
+  latch.RUnlock();
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, TryWLockTest) {
+  ReaderWriterLatch latch;
+  // Scenario: a reader or a writer keeps the writer out.
+  latch.RLock();
+  EXPECT_FALSE(latch.TryWLock());
+  latch.RUnlock();
+  EXPECT_TRUE(latch.TryWLock());
+  EXPECT_FALSE(latch.TryWLock());
+  EXPECT_FALSE(latch.TryRLock());
+  latch.WUnlock();
+  EXPECT_TRUE(latch.TryRLock());
+  latch.RUnlock();
+}
+// NOLINTNEXTLINE
+TEST(RWLatchTest, WriterPreferenceTest) {
+  // A steady stream of readers must not keep a waiting writer out forever.
+  ReaderWriterLatch latch;
+  std::atomic<bool> writer_done{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; tid++) {
+    readers.emplace_back([&latch, &writer_done]() {
+      while (!writer_done) {
+        latch.RLock();
+        std::this_thread::yield();
+        latch.RUnlock();
+      }
+    });
+  }
+  std::thread writer([&latch, &writer_done]() {
+    for (int i = 0; i < 100; i++) {
+      latch.WLock();
+      latch.WUnlock();
+    }
+    writer_done = true;
+  });
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_TRUE(writer_done);
+}
+
+// Latch throughput from 1 to 64 threads against std::shared_mutex, for a read-only and a read-mostly mix.
+// NOLINTNEXTLINE
+TEST(RWLatchTest, DISABLED_LatchBenchmark) {
+  constexpr int total_ops = 400000;
+
+  auto run = [](auto *latch, int num_threads, int write_percent) {
+    int64_t counter = 0;
+    const int ops_per_thread = total_ops / num_threads;
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([latch, &counter, ops_per_thread, write_percent, tid]() {
+        int64_t sum = 0;
+        for (int i = 0; i < ops_per_thread; i++) {
+          if ((i + tid) % 100 < write_percent) {
+            Lock(latch, true);
+            counter++;
+            Unlock(latch, true);
+          } else {
+            Lock(latch, false);
+            sum += counter;
+            Unlock(latch, false);
+          }
+        }
+        EXPECT_LE(0, sum);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<int64_t>(ops_per_thread * num_threads / elapsed.count());
+  };
+
+  for (int write_percent : {0, 10}) {
+    for (int num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+      ReaderWriterLatch latch;
+      std::shared_mutex shared_mutex;
+      std::cout << "writes: " << write_percent << "% threads: " << num_threads
+                << " ReaderWriterLatch ops/s: " << run(&latch, num_threads, write_percent)
+                << " std::shared_mutex ops/s: " << run(&shared_mutex, num_threads, write_percent) << std::endl;
+    }
+  }
+}
 }  // namespace bustub
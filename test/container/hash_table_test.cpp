@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <iostream>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -382,4 +385,150 @@ TEST(HashTableTest, ConcurrentTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, OptimisticReadTest) {
+  // Readers probe the block pages without latches while writers keep inserting and removing other keys in the same
+  // pages. Validated probes always see every stable key exactly once.
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+  constexpr int num_stable_keys = 200;
+  for (int i = 0; i < num_stable_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int tid = 0; tid < 2; tid++) {
+    writers.emplace_back([&ht, &done, tid]() {
+      while (!done) {
+        for (int i = 0; i < 100; i++) {
+          ht.Insert(nullptr, 10000 + tid * 1000 + i, i);
+        }
+        for (int i = 0; i < 100; i++) {
+          ht.Remove(nullptr, 10000 + tid * 1000 + i, i);
+        }
+      }
+    });
+  }
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 2; tid++) {
+    readers.emplace_back([&ht]() {
+      for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < num_stable_keys; i++) {
+          std::vector<int> res;
+          EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+          ASSERT_EQ(1, res.size());
+          EXPECT_EQ(i, res[0]);
+        }
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  done = true;
+  for (auto &writer : writers) {
+    writer.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// Read throughput of a hot page under concurrent writers: the page read latch against optimistic reads, and hash
+// table probes (which read optimistically) for reference.
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_OptimisticReadBenchmark) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+  for (int i = 0; i < 500; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+
+  constexpr int reads_per_thread = 200000;
+  constexpr int num_readers = 2;
+  auto run = [](int num_writers, auto &&read, auto &&write) {
+    std::atomic<bool> done{false};
+    std::vector<std::thread> writers;
+    for (int tid = 0; tid < num_writers; tid++) {
+      writers.emplace_back([&done, &write, tid]() {
+        for (int i = 0; !done; i++) {
+          write(tid, i);
+          std::this_thread::yield();
+        }
+      });
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> readers;
+    for (int tid = 0; tid < num_readers; tid++) {
+      readers.emplace_back([&read]() {
+        for (int i = 0; i < reads_per_thread; i++) {
+          read(i);
+        }
+      });
+    }
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    done = true;
+    for (auto &writer : writers) {
+      writer.join();
+    }
+    return static_cast<int64_t>(num_readers * reads_per_thread / elapsed.count());
+  };
+
+  auto page_write = [page](int /* tid */, int i) {
+    page->WLatch();
+    *reinterpret_cast<int *>(page->GetData() + 64) = i;
+    page->WUnlatch();
+  };
+  auto latched_read = [page](int /* i */) {
+    page->RLatch();
+    volatile int value = *reinterpret_cast<int *>(page->GetData() + 64);
+    (void)value;
+    page->RUnlatch();
+  };
+  auto optimistic_read = [page](int /* i */) {
+    int value;
+    uint64_t version;
+    do {
+      version = page->BeginOptimisticRead();
+      value = *reinterpret_cast<volatile int *>(page->GetData() + 64);
+    } while (!page->ValidateRead(version));
+    (void)value;
+  };
+  auto ht_write = [&ht](int tid, int i) {
+    const int key = 10000 + tid * 1000 + i % 100;
+    if (i / 100 % 2 == 0) {
+      ht.Insert(nullptr, key, 0);
+    } else {
+      ht.Remove(nullptr, key, 0);
+    }
+  };
+  auto ht_read = [&ht](int i) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i % 500, &res);
+  };
+
+  for (int num_writers : {0, 1, 2}) {
+    std::cout << "writers: " << num_writers << " page reads/s latched: " << run(num_writers, latched_read, page_write)
+              << " optimistic: " << run(num_writers, optimistic_read, page_write)
+              << " hash table probes/s: " << run(num_writers, ht_read, ht_write) << std::endl;
+  }
+
+  bpm->UnpinPage(page_id, false);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -67,6 +67,9 @@ class ExecutorTest : public ::testing::Test {
   /** @return the executor context in our test class */
   ExecutorContext *GetExecutorContext() { return exec_ctx_.get(); }
 
+  /** @return the disk manager in our test class */
+  DiskManager *GetDiskManager() { return disk_manager_.get(); }
+
   // The below helper functions are useful for testing.
 
   const AbstractExpression *MakeColumnValueExpression(const Schema &schema, uint32_t tuple_idx,
@@ -139,8 +142,8 @@ TEST_F(ExecutorTest, SimpleSeqScanTest) {
   Tuple tuple;
   uint32_t num_tuples = 0;
   std::cout << "ColA, ColB" << std::endl;
-  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(executor.get())->GetTableIterator()
-              == table_info->table_->Begin(GetExecutorContext()->GetTransaction()));  // Add by Jigao
+  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(executor.get())->GetTableIterator().GetRid()
+              == table_info->table_->Begin(GetExecutorContext()->GetTransaction())->GetRid());  // Add by Jigao
   while (executor->Next(&tuple)) {
     ASSERT_TRUE(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>() < 500);
     ASSERT_TRUE(tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>() < 10);
@@ -149,8 +152,7 @@ TEST_F(ExecutorTest, SimpleSeqScanTest) {
     num_tuples++;
   }
   ASSERT_EQ(num_tuples, 500);
-  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(executor.get())->GetTableIterator()
-              == table_info->table_->End());  // Add by Jigao
+  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(executor.get())->GetTableIterator().IsEnd());  // Add by Jigao
 }
 
 // Added by Jigao
@@ -170,15 +172,14 @@ TEST_F(ExecutorTest, SimpleSeqScanTest2) {
   Tuple tuple;
   uint32_t num_tuples = 0;
   std::cout << "ColB" << std::endl;
-  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(executor.get())->GetTableIterator()
-              == table_info->table_->Begin(GetExecutorContext()->GetTransaction()));  // Add by Jigao
+  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(executor.get())->GetTableIterator().GetRid()
+              == table_info->table_->Begin(GetExecutorContext()->GetTransaction())->GetRid());  // Add by Jigao
   while (executor->Next(&tuple)) {
     ASSERT_TRUE(tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>() < 5);
     std::cout << tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>() << std::endl;
     num_tuples++;
   }
-  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(executor.get())->GetTableIterator()
-              == table_info->table_->End());  // Add by Jigao
+  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(executor.get())->GetTableIterator().IsEnd());  // Add by Jigao
 }
 
 // NOLINTNEXTLINE
@@ -208,8 +209,8 @@ TEST_F(ExecutorTest, SimpleRawInsertTest) {
   Tuple tuple;
   std::cout << "ColA, ColB" << std::endl;
   // First value
-  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(scan_executor.get())->GetTableIterator()
-              == table_info->table_->Begin(GetExecutorContext()->GetTransaction()));  // Add by Jigao
+  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(scan_executor.get())->GetTableIterator().GetRid()
+              == table_info->table_->Begin(GetExecutorContext()->GetTransaction())->GetRid());  // Add by Jigao
   ASSERT_TRUE(scan_executor->Next(&tuple));
   ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 100);
   ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>(), 10);
@@ -229,8 +230,7 @@ TEST_F(ExecutorTest, SimpleRawInsertTest) {
             << tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>() << std::endl;
   // End
   ASSERT_FALSE(scan_executor->Next(&tuple));
-  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(scan_executor.get())->GetTableIterator()
-              == table_info->table_->End());  // Add by Jigao
+  ASSERT_TRUE(reinterpret_cast<SeqScanExecutor*>(scan_executor.get())->GetTableIterator().IsEnd());  // Add by Jigao
 }
 
 // NOLINTNEXTLINE
@@ -290,6 +290,59 @@ TEST_F(ExecutorTest, SimpleSelectInsertTest) {
   ASSERT_EQ(num_tuples, 500);
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BulkAccessSelectInsertTest) {
+  // INSERT INTO empty_table2 SELECT colA, colB FROM test_1, scanning and inserting through private rings of frames
+  GetExecutorContext()->SetBulkAccess(true);
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> insert_plan;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+    insert_plan = std::make_unique<InsertPlanNode>(scan_plan1.get(), table_info->oid_);
+  }
+  auto insert_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), insert_plan.get());
+  insert_executor->Init();
+  ASSERT_TRUE(insert_executor->Next(nullptr));
+
+  // Now iterate through both tables, and make sure they have the same data
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema2 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+
+  auto scan_executor1 = ExecutorFactory::CreateExecutor(GetExecutorContext(), scan_plan1.get());
+  scan_executor1->Init();
+  auto scan_executor2 = ExecutorFactory::CreateExecutor(GetExecutorContext(), scan_plan2.get());
+  scan_executor2->Init();
+  Tuple tuple1;
+  Tuple tuple2;
+  uint32_t num_tuples = 0;
+  while (scan_executor1->Next(&tuple1) && scan_executor2->Next(&tuple2)) {
+    ASSERT_EQ(tuple1.GetValue(out_schema1, out_schema1->GetColIdx("colA")).GetAs<int32_t>(),
+              tuple2.GetValue(out_schema2, out_schema2->GetColIdx("colA")).GetAs<int32_t>());
+    ASSERT_EQ(tuple1.GetValue(out_schema1, out_schema1->GetColIdx("colB")).GetAs<int32_t>(),
+              tuple2.GetValue(out_schema2, out_schema2->GetColIdx("colB")).GetAs<int32_t>());
+    num_tuples++;
+  }
+  ASSERT_EQ(num_tuples, TEST1_SIZE);
+  GetExecutorContext()->SetBulkAccess(false);
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleHashJoinTest) {
   // INSERT INTO empty_table2 SELECT colA, colB FROM test_1 WHERE colA < 500
@@ -406,6 +459,78 @@ TEST_F(ExecutorTest, SimpleHashJoinTest2) {
   ASSERT_EQ(num_tuples, 100);
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, HashJoinScarceFramesTest) {
+  // SELECT l.colA, l.colB, r.colA FROM test_1 l JOIN test_1 r ON l.colB = r.colA WHERE r.colA < 10
+  // Every key of the left side matches about 100 tuples spread over all tmp tuple pages, more pages than free frames.
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    auto colC = MakeColumnValueExpression(schema, 0, "colC");
+    auto colD = MakeColumnValueExpression(schema, 0, "colD");
+    // Repeat the wide columns to spread the left side over more tmp tuple pages.
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}, {"colC2", colC},
+                                    {"colD2", colD}, {"colC3", colC}, {"colD3", colD}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+    auto *const10 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(10));
+    auto *predicate = MakeComparisonExpression(colA, const10, ComparisonType::LessThan);
+    out_schema2 = MakeOutputSchema({{"colA", colA}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, predicate, table_info->oid_);
+  }
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  const Schema *out_final;
+  {
+    auto left_colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto left_colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+    auto right_colA = MakeColumnValueExpression(*out_schema2, 1, "colA");
+    std::vector<const AbstractExpression *> left_keys{left_colB};
+    std::vector<const AbstractExpression *> right_keys{right_colA};
+    auto predicate = MakeComparisonExpression(left_colB, right_colA, ComparisonType::Equal);
+    out_final = MakeOutputSchema({{"left_colA", left_colA}, {"left_colB", left_colB}, {"right_colA", right_colA}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()}, predicate,
+        std::move(left_keys), std::move(right_keys));
+  }
+
+  // Pin most of the buffer pool, so that the tmp tuple pages of a probe do not fit into the free frames at once.
+  auto bpm = GetExecutorContext()->GetBufferPoolManager();
+  std::vector<page_id_t> pinned_page_ids;
+  while (bpm->GetFreeListSize() + bpm->GetReplacerSize() > 6) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    pinned_page_ids.push_back(page_id);
+  }
+
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), join_plan.get());
+  executor->Init();
+  Tuple tuple;
+  uint32_t num_tuples = 0;
+  while (executor->Next(&tuple)) {
+    ASSERT_EQ(tuple.GetValue(out_final, 1).GetAs<int32_t>(), tuple.GetValue(out_final, 2).GetAs<int32_t>());
+    num_tuples++;
+  }
+  ASSERT_EQ(num_tuples, 10);
+  for (page_id_t page_id : pinned_page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // The tmp tuple pages are deleted with the executor, and their page ids are handed out again.
+  EXPECT_EQ(0, GetDiskManager()->GetNumFreePages());
+  const page_id_t num_allocated_pages = GetDiskManager()->GetNumAllocatedPages();
+  executor.reset();
+  EXPECT_LT(0, GetDiskManager()->GetNumFreePages());
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_LT(page_id, num_allocated_pages);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleAggregationTest) {
   // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
@@ -0,0 +1,190 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_test.cpp
+//
+// Identification: test/storage/async_io_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>  // NOLINT
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** Check that a page buffer holds "Page <page_id>". */
+static void CheckPageData(const char *data, page_id_t page_id) {
+  char expected[PAGE_SIZE];
+  snprintf(expected, PAGE_SIZE, "Page %d", page_id);
+  EXPECT_EQ(0, strcmp(data, expected)) << "page " << page_id;
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncIOTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 100;
+
+  for (bool io_uring : {true, false}) {
+    for (bool direct_io : {false, true}) {
+      enable_io_uring = io_uring;
+      remove(db_name.c_str());
+      auto *disk_manager = new DiskManager(db_name, direct_io);
+      if (!io_uring) {
+        EXPECT_STREQ("thread pool", disk_manager->GetAsyncIOBackend());
+      }
+      std::cout << "backend: " << disk_manager->GetAsyncIOBackend() << " direct I/O: " << disk_manager->IsDirectIO()
+                << std::endl;
+      std::unique_ptr<char, decltype(&free)> buffer(
+          static_cast<char *>(aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE)), &free);
+
+      // Scenario: a batch of writes in reverse order, with a gap, completes every page once.
+      std::vector<DiskManager::PageIO> writes;
+      for (page_id_t page_id = num_pages - 1; page_id >= 0; --page_id) {
+        if (page_id != num_pages / 2) {
+          char *data = buffer.get() + page_id * PAGE_SIZE;
+          memset(data, 0, PAGE_SIZE);
+          snprintf(data, PAGE_SIZE, "Page %d", page_id);
+          writes.push_back(DiskManager::PageIO{page_id, data, true});
+        }
+      }
+      std::vector<std::atomic<int>> completions(writes.size());
+      disk_manager->SubmitBatch(writes, [&completions](size_t i) { completions[i]++; }).get();
+      for (const auto &completion : completions) {
+        EXPECT_EQ(1, completion);
+      }
+      EXPECT_EQ(num_pages - 1, disk_manager->GetNumWrites());
+      char data[PAGE_SIZE];
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        disk_manager->ReadPage(page_id, data);
+        if (page_id == num_pages / 2) {
+          EXPECT_EQ(0, data[0]);
+        } else {
+          CheckPageData(data, page_id);
+        }
+      }
+
+      // Scenario: batched reads, with the gap and pages beyond the end of the file zeroed.
+      memset(buffer.get(), 0xff, num_pages * PAGE_SIZE);
+      std::vector<DiskManager::PageIO> reads;
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        reads.push_back(DiskManager::PageIO{page_id + num_pages / 2, buffer.get() + page_id * PAGE_SIZE, false});
+      }
+      disk_manager->SubmitBatch(reads).get();
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        const char *read = buffer.get() + page_id * PAGE_SIZE;
+        if (page_id == 0 || page_id + num_pages / 2 >= num_pages) {
+          EXPECT_EQ(0, read[0]);
+          EXPECT_EQ(0, read[PAGE_SIZE - 1]);
+        } else {
+          CheckPageData(read, page_id + num_pages / 2);
+        }
+      }
+
+      // Scenario: single asynchronous requests, from buffers which are not aligned for direct I/O.
+      std::vector<char> unaligned(PAGE_SIZE + 1);
+      snprintf(unaligned.data() + 1, PAGE_SIZE, "Page %d", num_pages / 2);
+      disk_manager->WritePageAsync(num_pages / 2, unaligned.data() + 1).get();
+      memset(unaligned.data(), 0, unaligned.size());
+      disk_manager->ReadPageAsync(num_pages / 2, unaligned.data() + 1).get();
+      CheckPageData(unaligned.data() + 1, num_pages / 2);
+
+      // Scenario: pages written asynchronously are read back through a buffer pool.
+      disk_manager->ShutDown();
+      delete disk_manager;
+      disk_manager = new DiskManager(db_name, direct_io);
+      auto *bpm = new BufferPoolManager(16, disk_manager);
+      std::vector<page_id_t> page_ids;
+      for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+        page_ids.push_back(page_id * 3);
+      }
+      std::vector<Page *> pages(page_ids.size());
+      EXPECT_TRUE(bpm->FetchPages(page_ids, pages.data()));
+      for (size_t i = 0; i < page_ids.size(); ++i) {
+        CheckPageData(pages[i]->GetData(), page_ids[i]);
+        EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+      }
+
+      // Scenario: requests after ShutDown, like the write-back of a buffer pool destroyed later, complete
+      // synchronously.
+      ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0]));
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[0], true));
+      disk_manager->ShutDown();
+      EXPECT_STREQ("none", disk_manager->GetAsyncIOBackend());
+      delete bpm;
+      disk_manager->WritePageAsync(0, data).get();
+      disk_manager->ReadPageAsync(0, data).get();
+
+      remove(db_name.c_str());
+      delete disk_manager;
+    }
+  }
+  enable_io_uring = true;
+}
+
+// Random page reads with direct I/O. Prints the throughput of blocking reads at queue depth 1, and of batches of
+// ASYNC_IO_QUEUE_DEPTH reads submitted at once, for each backend.
+// NOLINTNEXTLINE
+TEST(AsyncIOTest, DISABLED_AsyncIOBenchmark) {
+  const std::string db_name = "test.db";
+  const int num_pages = 4096;
+  const int num_reads = 8192;
+  const size_t batch_size = ASYNC_IO_QUEUE_DEPTH;
+
+  remove(db_name.c_str());
+  for (bool io_uring : {true, false}) {
+    enable_io_uring = io_uring;
+    auto *disk_manager = new DiskManager(db_name, true);
+    std::unique_ptr<char, decltype(&free)> buffer(
+        static_cast<char *>(aligned_alloc(PAGE_SIZE, batch_size * PAGE_SIZE)), &free);
+    if (io_uring) {
+      memset(buffer.get(), 0, batch_size * PAGE_SIZE);
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        disk_manager->WritePage(page_id, buffer.get());
+      }
+    }
+
+    std::mt19937 gen(0);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_reads; ++i) {
+      disk_manager->ReadPage(static_cast<page_id_t>(gen() % num_pages), buffer.get());
+    }
+    const std::chrono::duration<double> sync_elapsed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    std::vector<DiskManager::PageIO> reads(batch_size);
+    for (int i = 0; i < num_reads; i += batch_size) {
+      for (size_t j = 0; j < batch_size; ++j) {
+        reads[j] = DiskManager::PageIO{static_cast<page_id_t>(gen() % num_pages), buffer.get() + j * PAGE_SIZE, false};
+      }
+      disk_manager->SubmitBatch(reads).get();
+    }
+    const std::chrono::duration<double> async_elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "backend: " << disk_manager->GetAsyncIOBackend() << " direct I/O: " << disk_manager->IsDirectIO()
+              << " sync reads/s: " << static_cast<int64_t>(num_reads / sync_elapsed.count())
+              << " async reads/s (batches of " << batch_size
+              << "): " << static_cast<int64_t>(num_reads / async_elapsed.count()) << std::endl;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+  enable_io_uring = true;
+}
+
+}  // namespace bustub
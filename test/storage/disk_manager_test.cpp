@@ -0,0 +1,220 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_test.cpp
+//
+// Identification: test/storage/disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, AlignedFrameDataTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: every frame of a plain and of a partitioned pool starts on a page boundary.
+  for (size_t num_shards : {1, 4}) {
+    auto *bpm = new BufferPoolManager(16, disk_manager, nullptr, num_shards);
+    page_id_t page_id_temp;
+    for (int i = 0; i < 16; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+    }
+    delete bpm;
+  }
+
+  // Scenario: asking for huge pages is only advice, the pool works either way.
+  buffer_pool_huge_pages = true;
+  auto *bpm = new BufferPoolManager(16, disk_manager);
+  buffer_pool_huge_pages = false;
+  page_id_t page_id_temp;
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  delete bpm;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, DirectIOTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name, true);
+  if (!disk_manager->IsDirectIO()) {
+    std::cout << "direct I/O is not supported here, testing the buffered fallback" << std::endl;
+  }
+
+  // Scenario: reading past the end of the file returns a zeroed page.
+  alignas(PAGE_SIZE) char aligned[PAGE_SIZE];
+  memset(aligned, 'x', PAGE_SIZE);
+  disk_manager->ReadPage(5, aligned);
+  for (char c : aligned) {
+    ASSERT_EQ(0, c);
+  }
+
+  // Scenario: aligned and unaligned buffers round-trip.
+  char unaligned_storage[PAGE_SIZE + 1];
+  char *unaligned = unaligned_storage + 1;
+  snprintf(aligned, PAGE_SIZE, "aligned page");
+  snprintf(unaligned, PAGE_SIZE, "unaligned page");
+  disk_manager->WritePage(0, aligned);
+  disk_manager->WritePage(1, unaligned);
+  EXPECT_EQ(2, disk_manager->GetNumWrites());
+  disk_manager->ReadPage(1, aligned);
+  EXPECT_EQ(0, strcmp(aligned, "unaligned page"));
+  disk_manager->ReadPage(0, unaligned);
+  EXPECT_EQ(0, strcmp(unaligned, "aligned page"));
+
+  // Scenario: a buffer pool on top of a direct disk manager reads back evicted pages.
+  auto *bpm = new BufferPoolManager(4, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < 16; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t i = 0; i < 16; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "Page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  delete bpm;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const int num_threads = 4;
+  const int num_pages = 64;
+  const int num_rounds = 20;
+
+  for (bool direct_io : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name, direct_io);
+    // Every thread writes and reads back its own pages, while the others extend the file concurrently.
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([disk_manager, tid] {
+        alignas(PAGE_SIZE) char data[PAGE_SIZE];
+        alignas(PAGE_SIZE) char expected[PAGE_SIZE];
+        memset(expected, 0, PAGE_SIZE);
+        for (int round = 0; round < num_rounds; ++round) {
+          for (page_id_t page_id = tid; page_id < num_pages; page_id += num_threads) {
+            snprintf(expected, PAGE_SIZE, "Page %d round %d", page_id, round);
+            disk_manager->WritePage(page_id, expected);
+            disk_manager->ReadPage(page_id, data);
+            EXPECT_EQ(0, memcmp(data, expected, PAGE_SIZE));
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(num_threads * num_rounds * (num_pages / num_threads), disk_manager->GetNumWrites());
+    disk_manager->ShutDown();
+    delete disk_manager;
+
+    // Scenario: a reopened file knows its size, and pages beyond it read as zeroes.
+    disk_manager = new DiskManager(db_name, direct_io);
+    alignas(PAGE_SIZE) char data[PAGE_SIZE];
+    disk_manager->ReadPage(num_pages - 1, data);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "Page %d round %d", num_pages - 1, num_rounds - 1);
+    EXPECT_EQ(0, strcmp(data, expected));
+    memset(data, 'x', PAGE_SIZE);
+    disk_manager->ReadPage(num_pages, data);
+    for (char c : data) {
+      ASSERT_EQ(0, c);
+    }
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+  }
+}
+
+// Random single-page reads of a 64 MiB file with direct I/O, by 1 to 16 threads. Prints the reads per second with
+// the reads serialized by a global lock, like a disk manager sharing one file stream, and with concurrent positional
+// reads.
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, DISABLED_IOConcurrencyBenchmark) {
+  const std::string db_name = "test.db";
+  const int num_pages = (64 << 20) / PAGE_SIZE;
+  const int num_reads = 4000;
+
+  auto *disk_manager = new DiskManager(db_name, true);
+  {
+    alignas(PAGE_SIZE) char data[PAGE_SIZE];
+    memset(data, 0, PAGE_SIZE);
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      disk_manager->WritePage(page_id, data);
+    }
+  }
+  std::mutex global_lock;
+  for (int num_threads : {1, 4, 16}) {
+    for (bool serialized : {true, false}) {
+      std::vector<std::thread> threads;
+      const auto start = std::chrono::steady_clock::now();
+      for (int tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([disk_manager, &global_lock, serialized, num_threads, tid] {
+          alignas(PAGE_SIZE) char data[PAGE_SIZE];
+          std::mt19937 gen(tid);
+          for (int i = 0; i < num_reads / num_threads; ++i) {
+            const auto page_id = static_cast<page_id_t>(gen() % num_pages);
+            if (serialized) {
+              std::lock_guard<std::mutex> lock(global_lock);
+              disk_manager->ReadPage(page_id, data);
+            } else {
+              disk_manager->ReadPage(page_id, data);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "threads: " << num_threads << " serialized: " << serialized << " direct I/O: "
+                << disk_manager->IsDirectIO() << " reads/s: " << static_cast<int64_t>(num_reads / elapsed.count())
+                << std::endl;
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,206 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_test.cpp
+//
+// Identification: test/storage/free_page_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** @return the size of a file in bytes */
+static int64_t FileSize(const std::string &file_name) {
+  struct stat stat_buf;
+  return stat(file_name.c_str(), &stat_buf) == 0 ? stat_buf.st_size : -1;
+}
+
+// NOLINTNEXTLINE
+TEST(FreePageTest, SampleTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: pages are allocated in order while there is no free page.
+  for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+    EXPECT_EQ(page_id, disk_manager->AllocatePage());
+  }
+  EXPECT_EQ(10, disk_manager->GetNumAllocatedPages());
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  // Scenario: freed pages are reused before the file grows, the first one behind the hint first, then the lowest one.
+  disk_manager->DeallocatePage(2);
+  disk_manager->DeallocatePage(5);
+  disk_manager->DeallocatePage(7);
+  disk_manager->DeallocatePage(7);
+  disk_manager->DeallocatePage(42);
+  EXPECT_EQ(3, disk_manager->GetNumFreePages());
+  EXPECT_EQ(5, disk_manager->AllocatePage(4));
+  EXPECT_EQ(7, disk_manager->AllocatePage(7));
+  EXPECT_EQ(2, disk_manager->AllocatePage(8));
+  EXPECT_EQ(10, disk_manager->AllocatePage(3));
+  EXPECT_EQ(11, disk_manager->GetNumAllocatedPages());
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  // Scenario: the free pages and the high-water mark survive a restart, also across a bitmap group.
+  char data[PAGE_SIZE] = "Page 3";
+  disk_manager->WritePage(3, data);
+  disk_manager->DeallocatePage(4);
+  disk_manager->DeallocatePage(9);
+  disk_manager->ShutDown();
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(11, disk_manager->GetNumAllocatedPages());
+  EXPECT_EQ(2, disk_manager->GetNumFreePages());
+  memset(data, 0, PAGE_SIZE);
+  disk_manager->ReadPage(3, data);
+  EXPECT_STREQ("Page 3", data);
+  EXPECT_EQ(4, disk_manager->AllocatePage());
+  EXPECT_EQ(9, disk_manager->AllocatePage());
+  const page_id_t pages_per_bitmap = PAGE_SIZE * 8;
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  while (last_page_id < pages_per_bitmap + 1) {
+    last_page_id = disk_manager->AllocatePage();
+  }
+  disk_manager->DeallocatePage(pages_per_bitmap);
+  snprintf(data, PAGE_SIZE, "Page %d", last_page_id);
+  disk_manager->WritePage(last_page_id, data);
+  disk_manager->ShutDown();
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(pages_per_bitmap + 2, disk_manager->GetNumAllocatedPages());
+  EXPECT_EQ(1, disk_manager->GetNumFreePages());
+  memset(data, 0, PAGE_SIZE);
+  disk_manager->ReadPage(last_page_id, data);
+  EXPECT_EQ("Page " + std::to_string(last_page_id), std::string(data));
+  EXPECT_EQ(pages_per_bitmap, disk_manager->AllocatePage());
+
+  // Scenario: the pages deleted from a buffer pool are reused by its new pages.
+  auto *bpm = new BufferPoolManager(8, disk_manager);
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(pages_per_bitmap + 2, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  EXPECT_TRUE(bpm->DeletePage(page_id_temp));
+  EXPECT_TRUE(bpm->DeletePage(3));
+  ASSERT_NE(nullptr, bpm->NewPageWithStrategy(&page_id_temp, nullptr, 2));
+  EXPECT_EQ(3, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(pages_per_bitmap + 2, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  delete bpm;
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(FreePageTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const int num_threads = 8;
+  const int num_rounds = 2000;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Every thread keeps a few pages and frees them again. No page may be handed out twice.
+  std::vector<std::vector<page_id_t>> owned(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([disk_manager, tid, &owned] {
+      std::mt19937 gen(tid);
+      auto &pages = owned[tid];
+      for (int i = 0; i < num_rounds; ++i) {
+        if (pages.size() < 16 && gen() % 3 != 0) {
+          pages.push_back(disk_manager->AllocatePage(pages.empty() ? INVALID_PAGE_ID : pages.back()));
+        } else if (!pages.empty()) {
+          const size_t slot = gen() % pages.size();
+          disk_manager->DeallocatePage(pages[slot]);
+          pages[slot] = pages.back();
+          pages.pop_back();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::set<page_id_t> allocated;
+  for (const auto &pages : owned) {
+    for (const page_id_t page_id : pages) {
+      EXPECT_TRUE(allocated.insert(page_id).second) << "page " << page_id << " was handed out twice";
+    }
+  }
+  const auto high_water_mark = static_cast<size_t>(disk_manager->GetNumAllocatedPages());
+  EXPECT_LE(high_water_mark, static_cast<size_t>(num_threads * 16));
+  EXPECT_EQ(high_water_mark - allocated.size(), disk_manager->GetNumFreePages());
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+// A table whose pages are deleted and recreated over and over, through a buffer pool. Prints the size of the database
+// file: without page reuse it grows with every round, with reuse it stays at the size of the table.
+// NOLINTNEXTLINE
+TEST(FreePageTest, DISABLED_ChurnBenchmark) {
+  const std::string db_name = "test.db";
+  const int num_pages = 256;
+  const int num_rounds = 20;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+
+  std::vector<page_id_t> page_ids;
+  for (int round = 0; round < num_rounds; ++round) {
+    for (const page_id_t page_id : page_ids) {
+      EXPECT_TRUE(bpm->DeletePage(page_id));
+    }
+    page_ids.clear();
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id_temp;
+      auto *page = bpm->NewPageWithStrategy(&page_id_temp, nullptr, page_ids.empty() ? 0 : page_ids.back());
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Round %d", round);
+      page_ids.push_back(page_id_temp);
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+  }
+  EXPECT_EQ(num_pages, disk_manager->GetNumAllocatedPages());
+  EXPECT_TRUE(std::is_sorted(page_ids.begin(), page_ids.end()));
+
+  const int64_t file_size = FileSize(db_name);
+  std::cout << "rounds: " << num_rounds << " pages per round: " << num_pages
+            << " high-water mark: " << disk_manager->GetNumAllocatedPages() << " file size: " << file_size
+            << " bytes, without reuse: " << static_cast<int64_t>(num_rounds) * num_pages * PAGE_SIZE << " bytes"
+            << std::endl;
+  EXPECT_LE(file_size, static_cast<int64_t>(num_pages + 3) * PAGE_SIZE);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,214 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_size_test.cpp
+//
+// Identification: test/storage/page_size_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_block_page.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_iterator.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Write a file starting with a database file header recording page_size. */
+static void WriteFileHeader(const std::string &file_name, uint32_t page_size) {
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc | std::ios::out);
+  const uint32_t version = 1;
+  file.write("BUSTUBDB", 8);
+  file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+  file.write(reinterpret_cast<const char *>(&page_size), sizeof(page_size));
+}
+
+// NOLINTNEXTLINE
+TEST(PageSizeTest, SampleTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+
+  // Scenario: a new database records the page size of the build in its file header.
+  EXPECT_EQ(0, DiskManager::ReadFilePageSize(db_name));
+  auto *disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(PAGE_SIZE, DiskManager::ReadFilePageSize(db_name));
+  char data[PAGE_SIZE];
+  snprintf(data, PAGE_SIZE, "Page 0");
+  disk_manager->WritePage(0, data);
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: the pages stay readable after a reopen.
+  disk_manager = new DiskManager(db_name);
+  memset(data, 0, PAGE_SIZE);
+  disk_manager->ReadPage(0, data);
+  EXPECT_EQ(0, strcmp(data, "Page 0"));
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: a database created with another page size, and a file which is not a database, are refused.
+  WriteFileHeader(db_name, 2 * PAGE_SIZE);
+  EXPECT_EQ(2 * PAGE_SIZE, DiskManager::ReadFilePageSize(db_name));
+  EXPECT_THROW(DiskManager{db_name}, Exception);
+  {
+    std::ofstream file(db_name, std::ios::binary | std::ios::trunc | std::ios::out);
+    file << "not a database";
+  }
+  EXPECT_EQ(0, DiskManager::ReadFilePageSize(db_name));
+  EXPECT_THROW(DiskManager{db_name}, Exception);
+  EXPECT_THROW(DiskManager::MigrateLegacyFile(db_name), Exception);
+
+  // Scenario: a database written before the file header existed is refused, until it is migrated.
+  {
+    std::ofstream file(db_name, std::ios::binary | std::ios::trunc | std::ios::out);
+    for (int i = 0; i < 3; i++) {
+      memset(data, 0, PAGE_SIZE);
+      snprintf(data, PAGE_SIZE, "Page %d", i);
+      file.write(data, PAGE_SIZE);
+    }
+  }
+  try {
+    DiskManager disk_manager{db_name};
+    FAIL();
+  } catch (const Exception &e) {
+    EXPECT_EQ(ExceptionType::FILE_FORMAT, e.GetType());
+  }
+  DiskManager::MigrateLegacyFile(db_name);
+  EXPECT_EQ(PAGE_SIZE, DiskManager::ReadFilePageSize(db_name));
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(3, disk_manager->GetNumAllocatedPages());
+  for (int i = 0; i < 3; i++) {
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "Page %d", i);
+    disk_manager->ReadPage(i, data);
+    EXPECT_EQ(0, strcmp(data, expected));
+  }
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove((db_name + ".legacy").c_str());
+
+  // Scenario: the page layouts derive their capacity from the page size.
+  TmpTuplePage tmp_tuple_page{};
+  tmp_tuple_page.Init(0, PAGE_SIZE);
+  Schema schema{std::vector<Column>{{"a", TypeId::INTEGER}}};
+  const Tuple tuple({ValueFactory::GetIntegerValue(0)}, &schema);
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  size_t num_tmp_tuples = 0;
+  while (tmp_tuple_page.Insert(tuple, &tmp_tuple)) {
+    num_tmp_tuples++;
+  }
+  // A 12 byte header, then 4 bytes of size and 4 bytes of data per tuple.
+  EXPECT_EQ((PAGE_SIZE - 12) / 8, num_tmp_tuples);
+  using IntBlockPage = HashTableBlockPage<int, int, IntComparator>;
+  const size_t block_array_size = 4 * PAGE_SIZE / (4 * sizeof(std::pair<int, int>) + 1);
+  EXPECT_LE(sizeof(IntBlockPage) + block_array_size * sizeof(std::pair<int, int>), PAGE_SIZE);
+  EXPECT_GT(block_array_size * sizeof(std::pair<int, int>), PAGE_SIZE * 0.96);
+}
+
+// A cold full scan and cold random point lookups of a table through a buffer pool of a fixed number of bytes. Prints
+// the throughput of each for the page size of this build. The page-size-benchmark target builds and runs it for
+// 4, 8, 16 and 32 KiB pages.
+// NOLINTNEXTLINE
+TEST(PageSizeTest, DISABLED_PageSizeBenchmark) {
+  const std::string db_name = "test.db";
+  const int num_tuples = 100000;
+  const int num_lookups = 20000;
+  const size_t buffer_pool_bytes = 4 << 20;
+  const size_t default_read_ahead_pages = table_read_ahead_pages;
+  table_read_ahead_pages = 0;
+
+  remove(db_name.c_str());
+  Schema schema{std::vector<Column>{{"a", TypeId::INTEGER}, {"b", TypeId::VARCHAR, 128}}};
+  auto *disk_manager = new DiskManager(db_name, true);
+  auto *transaction = new Transaction(0);
+  const std::string padding(100, 'x');
+  std::vector<RID> rids;
+  page_id_t first_page_id;
+  {
+    // Fill the table pages directly: TableHeap::InsertTuple searches the page chain from the start for every tuple.
+    BufferPoolManager bpm(2 * num_tuples * 128 / PAGE_SIZE, disk_manager);
+    auto *page = static_cast<TablePage *>(bpm.NewPage(&first_page_id));
+    ASSERT_NE(nullptr, page);
+    page->Init(first_page_id, PAGE_SIZE, INVALID_PAGE_ID, nullptr, transaction);
+    for (int i = 0; i < num_tuples; ++i) {
+      const Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(padding)}, &schema);
+      RID rid;
+      while (!page->InsertTuple(tuple, &rid, transaction, nullptr, nullptr)) {
+        page_id_t next_page_id;
+        auto *next_page = static_cast<TablePage *>(bpm.NewPage(&next_page_id));
+        ASSERT_NE(nullptr, next_page);
+        next_page->Init(next_page_id, PAGE_SIZE, page->GetTablePageId(), nullptr, transaction);
+        page->SetNextPageId(next_page_id);
+        EXPECT_TRUE(bpm.UnpinPage(page->GetTablePageId(), true));
+        page = next_page;
+      }
+      rids.push_back(rid);
+    }
+    EXPECT_TRUE(bpm.UnpinPage(page->GetTablePageId(), true));
+    bpm.FlushAllPages();
+  }
+  const size_t num_pages = rids.back().GetPageId() - first_page_id + 1;
+
+  double scan_seconds;
+  {
+    BufferPoolManager bpm(buffer_pool_bytes / PAGE_SIZE, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, first_page_id);
+    int64_t sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    TablePageIterator itr(&table, transaction);
+    Tuple tuple;
+    while (itr.NextView(&tuple)) {
+      sum += tuple.GetValue(&schema, 0).GetAs<int32_t>();
+    }
+    scan_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(static_cast<int64_t>(num_tuples) * (num_tuples - 1) / 2, sum);
+  }
+
+  double lookup_seconds;
+  {
+    BufferPoolManager bpm(buffer_pool_bytes / PAGE_SIZE, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, first_page_id);
+    std::mt19937 gen(0);
+    Tuple tuple;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_lookups; ++i) {
+      const int key = static_cast<int>(gen() % num_tuples);
+      ASSERT_TRUE(table.GetTuple(rids[key], &tuple, transaction));
+      EXPECT_EQ(key, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    lookup_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  table_read_ahead_pages = default_read_ahead_pages;
+
+  std::cout << "page size: " << PAGE_SIZE << " tuples/page: " << num_tuples / num_pages
+            << " direct I/O: " << disk_manager->IsDirectIO()
+            << " scan MB/s: " << static_cast<int64_t>(num_pages * PAGE_SIZE / scan_seconds / (1 << 20))
+            << " lookups/s: " << static_cast<int64_t>(num_lookups / lookup_seconds) << std::endl;
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete transaction;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// superblock_test.cpp
+//
+// Identification: test/storage/superblock_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** Overwrite the high-water mark of the superblock at offset, leaving its checksum stale, the way a torn write does. */
+static void TearSuperblock(const std::string &file_name, int64_t offset) {
+  std::fstream file(file_name, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(offset + 16);
+  file.write("torn", 4);
+}
+
+// NOLINTNEXTLINE
+TEST(SuperblockTest, SampleTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+
+  // Scenario: the high-water mark and the catalog root survive a clean restart.
+  auto *disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(INVALID_PAGE_ID, disk_manager->GetCatalogRoot());
+  for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+    EXPECT_EQ(page_id, disk_manager->AllocatePage());
+  }
+  disk_manager->SetCatalogRoot(3);
+  char data[PAGE_SIZE] = "Page 9";
+  disk_manager->WritePage(9, data);
+  disk_manager->ShutDown();
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(10, disk_manager->GetNumAllocatedPages());
+  EXPECT_EQ(3, disk_manager->GetCatalogRoot());
+  EXPECT_EQ(10, disk_manager->AllocatePage());
+
+  // Scenario: after a crash, no page written before is handed out again. The page ids between the last allocated one
+  // and the high-water mark of the superblock are free.
+  const int num_syncs = disk_manager->GetNumSyncs();
+  for (page_id_t page_id = 11; page_id < 20; ++page_id) {
+    EXPECT_EQ(page_id, disk_manager->AllocatePage());
+  }
+  snprintf(data, PAGE_SIZE, "Page 19");
+  disk_manager->WritePage(19, data);
+  EXPECT_EQ(num_syncs, disk_manager->GetNumSyncs());
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(10 + DiskManager::HIGH_WATER_MARK_STEP, disk_manager->GetNumAllocatedPages());
+  EXPECT_EQ(static_cast<size_t>(DiskManager::HIGH_WATER_MARK_STEP - 10), disk_manager->GetNumFreePages());
+  EXPECT_EQ(20, disk_manager->AllocatePage(19));
+  memset(data, 0, PAGE_SIZE);
+  disk_manager->ReadPage(19, data);
+  EXPECT_STREQ("Page 19", data);
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(SuperblockTest, TornSuperblockTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    disk_manager->AllocatePage();
+  }
+  disk_manager->SetCatalogRoot(1);
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: a torn superblock is read from the copy, and repaired on open.
+  TearSuperblock(db_name, 0);
+  EXPECT_EQ(PAGE_SIZE, DiskManager::ReadFilePageSize(db_name));
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(5, disk_manager->GetNumAllocatedPages());
+  EXPECT_EQ(1, disk_manager->GetCatalogRoot());
+  disk_manager->ShutDown();
+  delete disk_manager;
+  TearSuperblock(db_name, PAGE_SIZE);
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(5, disk_manager->GetNumAllocatedPages());
+  EXPECT_EQ(1, disk_manager->GetCatalogRoot());
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: a database without a valid superblock is refused.
+  TearSuperblock(db_name, 0);
+  TearSuperblock(db_name, PAGE_SIZE);
+  EXPECT_THROW(DiskManager{db_name}, Exception);
+  remove(db_name.c_str());
+}
+
+// A large database, sparse on disk, with its last page in use. Prints the time of opening it, which only reads the
+// superblock, and of the first allocation, which reads the allocation bitmaps.
+// NOLINTNEXTLINE
+TEST(SuperblockTest, DISABLED_OpenBenchmark) {
+  const std::string db_name = "test.db";
+  const page_id_t num_pages = 1 << 20;
+  remove(db_name.c_str());
+
+  auto *disk_manager = new DiskManager(db_name);
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    last_page_id = disk_manager->AllocatePage();
+  }
+  char data[PAGE_SIZE] = "last page";
+  disk_manager->WritePage(last_page_id, data);
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  auto start = std::chrono::steady_clock::now();
+  disk_manager = new DiskManager(db_name);
+  const std::chrono::duration<double, std::milli> open_elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(num_pages, disk_manager->GetNumAllocatedPages());
+  start = std::chrono::steady_clock::now();
+  EXPECT_EQ(num_pages, disk_manager->AllocatePage());
+  const std::chrono::duration<double, std::milli> allocate_elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "database size MB: " << static_cast<int64_t>(num_pages) * PAGE_SIZE / (1 << 20)
+            << " open ms: " << open_elapsed.count() << " first allocation ms: " << allocate_elapsed.count()
+            << std::endl;
+
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+}  // namespace bustub
@@ -0,0 +1,202 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_page_iterator_test.cpp
+//
+// Identification: test/table/table_page_iterator_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_iterator.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Fill a table with num_tuples tuples (i, padding), and return their RIDs. */
+static std::vector<RID> FillTable(TableHeap *table, const Schema *schema, int num_tuples, Transaction *txn) {
+  const std::string padding(100, 'x');
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; ++i) {
+    RID rid;
+    EXPECT_TRUE(table->InsertTuple(
+        Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(padding)}, schema), &rid, txn));
+    rids.push_back(rid);
+  }
+  return rids;
+}
+
+// NOLINTNEXTLINE
+TEST(TablePageIteratorTest, SampleTest) {
+  Schema schema{std::vector<Column>{{"a", TypeId::INTEGER}, {"b", TypeId::VARCHAR, 128}}};
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+
+  // Scenario: an empty table has no tuples and releases its pin.
+  {
+    TablePageIterator itr(table, transaction);
+    Tuple tuple;
+    EXPECT_TRUE(itr.IsEnd());
+    EXPECT_FALSE(itr.Next(&tuple));
+  }
+  EXPECT_EQ(0, bpm->GetPagePinCount(table->GetFirstPageId()));
+
+  // Delete every third tuple, and all tuples of a page in the middle.
+  const std::vector<RID> rids = FillTable(table, &schema, 1000, transaction);
+  const page_id_t middle_page_id = rids[rids.size() / 2].GetPageId();
+  ASSERT_NE(rids.front().GetPageId(), middle_page_id);
+  ASSERT_NE(rids.back().GetPageId(), middle_page_id);
+  std::vector<int> expected;
+  for (int i = 0; i < static_cast<int>(rids.size()); ++i) {
+    if (i % 3 == 1 || rids[i].GetPageId() == middle_page_id) {
+      EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    } else {
+      expected.push_back(i);
+    }
+  }
+
+  // Scenario: copies and views yield the live tuples in insertion order, skipping the deleted ones.
+  for (bool zero_copy : {false, true}) {
+    TablePageIterator itr(table, transaction);
+    EXPECT_EQ(rids[0], itr.GetRid());
+    Tuple tuple;
+    size_t count = 0;
+    while (zero_copy ? itr.NextView(&tuple) : itr.Next(&tuple)) {
+      ASSERT_LT(count, expected.size());
+      EXPECT_EQ(expected[count], tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(rids[expected[count]], tuple.GetRid());
+      EXPECT_EQ(zero_copy, !tuple.IsAllocated());
+      // Only the page of the cursor is pinned.
+      EXPECT_EQ(1, bpm->GetPagePinCount(tuple.GetRid().GetPageId()));
+      ++count;
+    }
+    EXPECT_EQ(expected.size(), count);
+    EXPECT_TRUE(itr.IsEnd());
+    EXPECT_FALSE(itr.Next(&tuple));
+  }
+  EXPECT_EQ(0, bpm->GetPagePinCount(rids.back().GetPageId()));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TablePageIteratorTest, BulkScanTest) {
+  const int num_tuples = 1000;
+  const size_t default_read_ahead_pages = table_read_ahead_pages;
+  table_read_ahead_pages = 8;
+
+  Schema schema{std::vector<Column>{{"a", TypeId::INTEGER}, {"b", TypeId::VARCHAR, 128}}};
+  auto *disk_manager = new DiskManager("test.db");
+  auto *transaction = new Transaction(0);
+  page_id_t first_page_id;
+  {
+    BufferPoolManager bpm(num_tuples / 8, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, transaction);
+    first_page_id = table.GetFirstPageId();
+    FillTable(&table, &schema, num_tuples, transaction);
+    bpm.FlushAllPages();
+  }
+
+  // Scenario: a cold scan with a bulk access strategy stays inside its ring and does not read ahead.
+  BufferPoolManager bpm(32, disk_manager);
+  TableHeap table(&bpm, nullptr, nullptr, first_page_id);
+  BufferAccessStrategy strategy(&bpm);
+  TablePageIterator itr(&table, transaction, &strategy);
+  Tuple tuple;
+  int count = 0;
+  while (itr.Next(&tuple)) {
+    EXPECT_EQ(count++, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, count);
+  EXPECT_EQ(0, bpm.GetNumPrefetches());
+  EXPECT_GE(strategy.GetRingSize(), bpm.GetPageTableSize());
+  table_read_ahead_pages = default_read_ahead_pages;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete transaction;
+  delete disk_manager;
+}
+
+// Sequential scan of a table in the buffer pool with TableIterator, and with TablePageIterator copying tuples or
+// handing out views. Prints the throughput of each.
+// NOLINTNEXTLINE
+TEST(TablePageIteratorTest, DISABLED_ScanBenchmark) {
+  const int num_tuples = 10000;
+  const int num_scans = 10;
+  const size_t default_read_ahead_pages = table_read_ahead_pages;
+  table_read_ahead_pages = 0;
+
+  Schema schema{std::vector<Column>{{"a", TypeId::INTEGER}, {"b", TypeId::VARCHAR, 128}}};
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(512, disk_manager);
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  FillTable(table, &schema, num_tuples, transaction);
+
+  auto run = [&](const std::string &name, auto &&scan) {
+    const auto start = std::chrono::steady_clock::now();
+    int64_t sum = 0;
+    for (int i = 0; i < num_scans; ++i) {
+      sum += scan();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(static_cast<int64_t>(num_scans) * num_tuples * (num_tuples - 1) / 2, sum);
+    std::cout << name << " tuples/s: " << static_cast<int64_t>(num_scans * num_tuples / elapsed.count())
+              << std::endl;
+  };
+  run("TableIterator", [&]() {
+    int64_t sum = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      sum += itr->GetValue(&schema, 0).GetAs<int32_t>();
+    }
+    return sum;
+  });
+  run("TablePageIterator copy", [&]() {
+    int64_t sum = 0;
+    TablePageIterator itr(table, transaction);
+    Tuple tuple;
+    while (itr.Next(&tuple)) {
+      sum += tuple.GetValue(&schema, 0).GetAs<int32_t>();
+    }
+    return sum;
+  });
+  run("TablePageIterator view", [&]() {
+    int64_t sum = 0;
+    TablePageIterator itr(table, transaction);
+    Tuple tuple;
+    while (itr.NextView(&tuple)) {
+      sum += tuple.GetValue(&schema, 0).GetAs<int32_t>();
+    }
+    return sum;
+  });
+  table_read_ahead_pages = default_read_ahead_pages;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
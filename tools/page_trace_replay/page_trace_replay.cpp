@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_trace_replay.cpp
+//
+// Identification: tools/page_trace_replay/page_trace_replay.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Replays a page trace recorded with BufferPoolManager::StartPageTrace against every replacement policy and a sweep
+// of pool sizes, and prints the miss-ratio curves as CSV.
+//
+// Usage: page_trace_replay <trace file> [pool size...]
+// Without pool sizes, the sweep doubles from 16 frames up to the number of distinct pages in the trace.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/page_trace_simulator.h"
+
+int main(int argc, char **argv) {
+  using bustub::BufferPoolManager;
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <trace file> [pool size...]" << std::endl;
+    return 1;
+  }
+  std::vector<bustub::PageTraceRecord> trace;
+  if (!bustub::PageTraceRecorder::ReadTrace(argv[1], &trace)) {
+    std::cerr << "cannot read trace file " << argv[1] << std::endl;
+    return 1;
+  }
+  const bustub::PageTraceSimulator simulator(std::move(trace));
+
+  std::vector<size_t> pool_sizes;
+  for (int i = 2; i < argc; i++) {
+    const auto pool_size = std::strtoul(argv[i], nullptr, 10);
+    if (pool_size == 0) {
+      std::cerr << "invalid pool size " << argv[i] << std::endl;
+      return 1;
+    }
+    pool_sizes.push_back(pool_size);
+  }
+  if (pool_sizes.empty()) {
+    size_t pool_size = 16;
+    for (; pool_size < simulator.GetNumDistinctPages(); pool_size *= 2) {
+      pool_sizes.push_back(pool_size);
+    }
+    pool_sizes.push_back(pool_size);
+  }
+
+  const std::vector<std::pair<std::string, BufferPoolManager::ReplacerType>> policies = {
+      {"clock", BufferPoolManager::ReplacerType::CLOCK},
+      {"lru_k", BufferPoolManager::ReplacerType::LRU_K},
+      {"arc", BufferPoolManager::ReplacerType::ARC}};
+  std::vector<std::vector<double>> curves;
+  for (const auto &policy : policies) {
+    curves.push_back(simulator.MissRatioCurve(policy.second, pool_sizes));
+  }
+
+  std::cout << "# distinct pages: " << simulator.GetNumDistinctPages() << std::endl;
+  std::cout << "pool_size";
+  for (const auto &policy : policies) {
+    std::cout << "," << policy.first;
+  }
+  std::cout << std::endl;
+  for (size_t i = 0; i < pool_sizes.size(); i++) {
+    std::cout << pool_sizes[i];
+    for (const auto &curve : curves) {
+      std::cout << "," << curve[i];
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}